@@ -0,0 +1,17 @@
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+namespace utils {
+
+/**
+ * @brief Number of heap allocations made through operator new since the program started.
+ *
+ * Every form of the global operator new and delete is replaced in alloc_counter.cpp to keep this count.
+ *
+ * @return The number of allocations.
+ */
+unsigned long long AllocationCount();
+
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <cstdlib>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include "node.hpp"
+#include "utils.hpp"
+
+#ifdef DIST_FLOAT
+using dist_t = float;
+#else
+using dist_t = double;
+#endif
+
+/**
+ * @brief Precomputed distance matrix of an instance.
+ *
+ * Stores the distance between every pair of nodes in a single row-major buffer. Each row
+ * is padded to a multiple of the cache line size and the buffer is cache-line aligned, so
+ * a lookup is a single load. The storage type is controlled by DIST_FLOAT at compile time.
+ */
+class DistanceMatrix
+{
+public:
+    static constexpr size_t CACHE_LINE = 64;
+
+    DistanceMatrix() : m_size(0), m_stride(0), m_data(nullptr, &std::free), m_values(nullptr) {}
+
+    explicit DistanceMatrix(const std::vector<Node>& nodes)
+        : DistanceMatrix()
+    {
+        Build(nodes);
+    }
+
+    /**
+     * @param nodes Nodes of the instance, indexed as in the DNA (0 is the depot).
+     * @param weights Explicit distances, as a full row-major matrix; if empty, the Euclidean
+     * distances of the nodes are used.
+     */
+    DistanceMatrix(const std::vector<Node>& nodes, const std::vector<double>& weights)
+        : DistanceMatrix()
+    {
+        if (weights.empty())
+            Build(nodes);
+        else
+            Build(weights, nodes.size());
+    }
+
+    /**
+     * @brief Copies explicit distances.
+     *
+     * @param weights Full row-major matrix of n x n distances.
+     * @param n Number of nodes.
+     */
+    inline void Build(const std::vector<double>& weights, size_t n)
+    {
+        Allocate(n);
+
+        for (size_t i = 0; i < m_size; ++i)
+            for (size_t j = 0; j < m_size; ++j)
+                m_data.get()[i * m_stride + j] = static_cast<dist_t>(weights[i * n + j]);
+    }
+
+    /**
+     * @brief Computes the distance between every pair of nodes.
+     *
+     * @param nodes Nodes of the instance, indexed as in the DNA (0 is the depot).
+     */
+    inline void Build(const std::vector<Node>& nodes)
+    {
+        Allocate(nodes.size());
+
+        for (size_t i = 0; i < m_size; ++i)
+        {
+            dist_t* row = m_data.get() + i * m_stride;
+            row[i] = 0;
+
+            for (size_t j = 0; j < i; ++j)
+            {
+                dist_t d = static_cast<dist_t>(utils::Distance(nodes[i], nodes[j]));
+                row[j] = d;
+                m_data.get()[j * m_stride + i] = d;
+            }
+        }
+    }
+
+    /**
+     * @brief Uses distances stored elsewhere (e.g. a memory-mapped cache) instead of owning them.
+     *
+     * @param values Row-major distances with the same padded layout as Build produces; must
+     * stay valid while the matrix is used.
+     * @param n Number of nodes.
+     * @param stride Distance between two rows, in elements.
+     */
+    inline void Attach(const dist_t* values, size_t n, size_t stride)
+    {
+        m_data.reset();
+        m_size = n;
+        m_stride = stride;
+        m_values = values;
+    }
+
+    dist_t operator()(int i, int j) const { return m_values[i * m_stride + j]; }
+
+    const dist_t* row(int i) const { return m_values + i * m_stride; }
+    const dist_t* data() const { return m_values; }
+
+    size_t size() const { return this->m_size; }
+    size_t stride() const { return this->m_stride; }
+
+private:
+    size_t m_size;
+    size_t m_stride;
+    std::unique_ptr<dist_t[], decltype(&std::free)> m_data;
+    const dist_t* m_values;     // m_data, or the attached distances.
+
+    inline void Allocate(size_t n)
+    {
+        constexpr size_t perLine = CACHE_LINE / sizeof(dist_t);
+
+        m_size = n;
+        m_stride = (n + perLine - 1) / perLine * perLine;
+
+        size_t bytes = m_size * m_stride * sizeof(dist_t);
+        if (bytes == 0)
+            bytes = CACHE_LINE;
+
+        void* ptr = std::aligned_alloc(CACHE_LINE, bytes);
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+
+        m_data.reset(static_cast<dist_t*>(ptr));
+        m_values = m_data.get();
+    }
+};
+
+#endif
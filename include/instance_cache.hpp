@@ -0,0 +1,323 @@
+#ifndef INSTANCE_CACHE_H
+#define INSTANCE_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "node.hpp"
+#include "distance_matrix.hpp"
+#include "neighbor_lists.hpp"
+#include "instance_reader.hpp"
+#include "../src/parameters.hpp"
+
+namespace utils {
+
+/**
+ * @brief Header of a preprocessed instance file.
+ *
+ * The file is the header followed by sections, each starting at a multiple of 64 bytes:
+ *
+ * - coordinates: dimension x values, then dimension y values (double);
+ * - demands: dimension values (double);
+ * - distance matrix (optional): dimension rows of matrixStride values of distSize bytes, in the
+ *   padded layout of DistanceMatrix, so it can be used in place;
+ * - neighbor lists (optional): dimension rows of neighbors values (int32).
+ *
+ * Everything is in the byte order of the machine that wrote the file; byteOrder tells it.
+ */
+struct InstanceCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t flags;
+    uint32_t distSize;
+    uint64_t dimension;
+    int64_t capacity;
+    int32_t maxX;
+    int32_t maxY;
+    uint32_t neighbors;
+    uint32_t reserved;
+    uint64_t matrixStride;
+    uint64_t coordinatesOffset;
+    uint64_t demandsOffset;
+    uint64_t matrixOffset;
+    uint64_t neighborsOffset;
+    uint64_t fileSize;
+};
+
+static_assert(std::is_trivially_copyable<InstanceCacheHeader>::value, "The header is written as raw bytes");
+
+namespace detail {
+
+constexpr char CACHE_MAGIC[8] = { 'C', 'V', 'R', 'P', 'B', 'I', 'N', '\0' };
+constexpr uint32_t CACHE_VERSION = 1;
+constexpr uint32_t CACHE_BYTE_ORDER = 0x01020304;
+constexpr uint64_t CACHE_ALIGNMENT = 64;
+
+constexpr uint32_t CACHE_HAS_COORDINATES = 1;
+constexpr uint32_t CACHE_HAS_MATRIX = 2;
+constexpr uint32_t CACHE_HAS_NEIGHBORS = 4;
+constexpr uint32_t CACHE_EXPLICIT = 8;      // Distances are not the Euclidean ones of the coordinates.
+
+inline uint64_t AlignCache(uint64_t offset)
+{
+    return (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+}
+
+/**
+ * @brief Tells if a file is a preprocessed instance, from its first bytes.
+ */
+inline bool IsInstanceCache(const std::string& path)
+{
+    char magic[sizeof(detail::CACHE_MAGIC)] = {};
+    std::ifstream file(path, std::ios::binary);
+    file.read(magic, sizeof(magic));
+
+    return file && std::memcmp(magic, detail::CACHE_MAGIC, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Writes a preprocessed instance: nodes, distance matrix and neighbor lists.
+ *
+ * @param path Output file.
+ * @param param Parameters filled by the reader (capacity and coordinate bounds).
+ * @param instance Instance as read from the text file.
+ * @param distances
+ * @param neighbors
+ *
+ * @return false if the file cannot be written.
+ */
+inline bool WriteInstanceCache(const std::string& path, const Parameters* param, const Instance& instance,
+                               const DistanceMatrix& distances, const NeighborLists& neighbors)
+{
+    const size_t n = instance.nodes.size();
+
+    InstanceCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, detail::CACHE_MAGIC, sizeof(header.magic));
+    header.version = detail::CACHE_VERSION;
+    header.byteOrder = detail::CACHE_BYTE_ORDER;
+    header.flags = detail::CACHE_HAS_MATRIX | (neighbors.k() > 0 ? detail::CACHE_HAS_NEIGHBORS : 0) |
+                   (instance.hasCoordinates ? detail::CACHE_HAS_COORDINATES : 0) |
+                   (instance.weights.empty() ? 0 : detail::CACHE_EXPLICIT);
+    header.distSize = sizeof(dist_t);
+    header.dimension = n;
+    header.capacity = param->capacity;
+    header.maxX = param->max_x;
+    header.maxY = param->max_y;
+    header.neighbors = static_cast<uint32_t>(neighbors.k());
+    header.matrixStride = distances.stride();
+
+    header.coordinatesOffset = detail::AlignCache(sizeof(header));
+    header.demandsOffset = detail::AlignCache(header.coordinatesOffset + 2 * n * sizeof(double));
+    header.matrixOffset = detail::AlignCache(header.demandsOffset + n * sizeof(double));
+    header.neighborsOffset = detail::AlignCache(header.matrixOffset + n * header.matrixStride * sizeof(dist_t));
+    header.fileSize = header.neighborsOffset + n * header.neighbors * sizeof(int32_t);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Error: Cannot write file " << path << std::endl;
+        return false;
+    }
+
+    uint64_t written = 0;
+    auto write = [&file, &written](const void* data, uint64_t bytes) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    };
+    auto pad = [&](uint64_t offset) {
+        static const char zeros[detail::CACHE_ALIGNMENT] = {};
+        write(zeros, offset - written);
+    };
+
+    write(&header, sizeof(header));
+
+    std::vector<double> values(n);
+    pad(header.coordinatesOffset);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = instance.nodes[i].getX();
+    write(values.data(), n * sizeof(double));
+    for (size_t i = 0; i < n; ++i)
+        values[i] = instance.nodes[i].getY();
+    write(values.data(), n * sizeof(double));
+
+    pad(header.demandsOffset);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = instance.nodes[i].getDemand();
+    write(values.data(), n * sizeof(double));
+
+    pad(header.matrixOffset);
+    write(distances.data(), n * header.matrixStride * sizeof(dist_t));
+
+    pad(header.neighborsOffset);
+    for (size_t i = 0; i < n; ++i)
+        write(neighbors.of(static_cast<int>(i)), header.neighbors * sizeof(int32_t));
+
+    return static_cast<bool>(file);
+}
+
+/**
+ * @brief Opens a preprocessed instance.
+ *
+ * The file stays mapped in `file`; when the matrix and the neighbor lists of the file fit this
+ * build (same distance type, at least as many neighbors as requested), `distances` and
+ * `neighbors` are attached to the mapping and share its pages with every other process reading
+ * the same file. Otherwise they are rebuilt.
+ *
+ * @param param Parameters with the path of the file; receives dimension, capacity and bounds.
+ * @param file Mapping of the file; must outlive `distances` and `neighbors`.
+ * @param instance Receives the nodes.
+ * @param distances
+ * @param neighbors
+ *
+ * @return false if the file cannot be read or is not a valid preprocessed instance.
+ * @throw std::runtime_error if it has no positive capacity or a customer whose demand exceeds it.
+ */
+inline bool ReadInstanceCache(Parameters* param, MappedFile& file, Instance& instance, DistanceMatrix& distances,
+                              NeighborLists& neighbors)
+{
+    instance = Instance();
+
+    if (!file.Open(param->input_file, false))
+    {
+        std::cerr << "Error: Cannot open file " << param->input_file << std::endl;
+        return false;
+    }
+
+    InstanceCacheHeader header;
+    bool valid = file.size() >= sizeof(header);
+    if (valid)
+    {
+        std::memcpy(&header, file.data(), sizeof(header));
+        uint64_t n = header.dimension;
+
+        valid = std::memcmp(header.magic, detail::CACHE_MAGIC, sizeof(header.magic)) == 0 &&
+                header.byteOrder == detail::CACHE_BYTE_ORDER;
+
+        if (valid && header.version != detail::CACHE_VERSION)
+        {
+            std::cerr << "Error: " << param->input_file << " has version " << header.version << " of the preprocessed format, expected "
+                      << detail::CACHE_VERSION << ". Run --preprocess again." << std::endl;
+            return false;
+        }
+
+        // Sizes first, so that the products below cannot overflow; then every section must lie
+        // past the header, aligned for the values read from it in place.
+        valid = valid && header.fileSize == file.size() &&
+                (header.distSize == sizeof(float) || header.distSize == sizeof(double)) &&
+                n <= header.fileSize / (3 * sizeof(double)) &&
+                (n == 0 || header.matrixStride <= header.fileSize / header.distSize / n) &&
+                (n == 0 || header.neighbors <= header.fileSize / sizeof(int32_t) / n) &&
+                header.coordinatesOffset >= sizeof(header) && header.coordinatesOffset % sizeof(double) == 0 &&
+                header.demandsOffset % sizeof(double) == 0 && header.matrixOffset % sizeof(double) == 0 &&
+                header.neighborsOffset % sizeof(int32_t) == 0 &&
+                header.demandsOffset >= header.coordinatesOffset + 2 * n * sizeof(double) &&
+                header.matrixOffset >= header.demandsOffset + n * sizeof(double) &&
+                (!(header.flags & detail::CACHE_HAS_MATRIX) ||
+                 (header.matrixStride >= n && header.neighborsOffset >= header.matrixOffset + n * header.matrixStride * header.distSize)) &&
+                header.neighborsOffset <= header.fileSize &&
+                header.fileSize - header.neighborsOffset >= n * header.neighbors * sizeof(int32_t);
+    }
+
+    if (!valid)
+    {
+        std::cerr << "Error: " << param->input_file << " is not a valid preprocessed instance." << std::endl;
+        return false;
+    }
+
+    const size_t n = header.dimension;
+    const double* xs = reinterpret_cast<const double*>(file.data() + header.coordinatesOffset);
+    const double* ys = xs + n;
+    const double* demands = reinterpret_cast<const double*>(file.data() + header.demandsOffset);
+
+    instance.nodes.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        instance.nodes.emplace_back(static_cast<int>(i) + 1, xs[i], ys[i], demands[i]);
+    instance.hasCoordinates = header.flags & detail::CACHE_HAS_COORDINATES;
+
+    // The file may come from an older reader, which accepted any capacity.
+    detail::CheckCapacity(instance.nodes, static_cast<long>(header.capacity));
+
+    bool hasMatrix = header.flags & detail::CACHE_HAS_MATRIX;
+    bool euclidean = instance.hasCoordinates && !(header.flags & detail::CACHE_EXPLICIT);
+    if (hasMatrix && header.distSize == sizeof(dist_t))
+        distances.Attach(reinterpret_cast<const dist_t*>(file.data() + header.matrixOffset), n, header.matrixStride);
+    else if (euclidean)
+        distances.Build(instance.nodes);
+    else if (hasMatrix)
+    {
+        // Written by a build with the other distance type; explicit distances can only be
+        // converted, Euclidean ones are computed again above at the precision of this build.
+        instance.weights.resize(n * n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                const char* value = file.data() + header.matrixOffset + (i * header.matrixStride + j) * header.distSize;
+                if (header.distSize == sizeof(float))
+                {
+                    float w;
+                    std::memcpy(&w, value, sizeof(w));
+                    instance.weights[i * n + j] = w;
+                }
+                else
+                {
+                    double w;
+                    std::memcpy(&w, value, sizeof(w));
+                    instance.weights[i * n + j] = w;
+                }
+            }
+        distances.Build(instance.weights, n);
+    }
+    else
+    {
+        std::cerr << "Error: " << param->input_file << " has neither coordinates nor distances." << std::endl;
+        return false;
+    }
+
+    int k = std::max(0, std::min(param->neighbors, static_cast<int>(n) - 2));
+    bool attach = (header.flags & detail::CACHE_HAS_NEIGHBORS) && static_cast<int>(header.neighbors) >= k;
+
+    if (attach)
+    {
+        // The lists index the matrix and the routes directly: every value must be a customer
+        // other than the node of its own row.
+        const int32_t* values = reinterpret_cast<const int32_t*>(file.data() + header.neighborsOffset);
+        for (size_t i = 0; i < n; ++i)
+            for (int j = 0; j < k; ++j)
+            {
+                int32_t customer = values[i * header.neighbors + j];
+                if (customer < 1 || static_cast<uint64_t>(customer) >= n || static_cast<size_t>(customer) == i)
+                {
+                    std::cerr << "Error: " << param->input_file << " is not a valid preprocessed instance." << std::endl;
+                    return false;
+                }
+            }
+    }
+
+    if (attach)
+        neighbors.Attach(reinterpret_cast<const int*>(file.data() + header.neighborsOffset), n,
+                         static_cast<int>(header.neighbors), k);
+    else if (euclidean)
+        neighbors.Build(instance.nodes, k);
+    else
+        neighbors.Build(distances, k);
+
+    param->dimension = static_cast<int>(n);
+    param->capacity = static_cast<int>(header.capacity);
+    param->max_x = header.maxX;
+    param->max_y = header.maxY;
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,447 @@
+#ifndef INSTANCE_READER_H
+#define INSTANCE_READER_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "node.hpp"
+#include "../src/parameters.hpp"
+
+#ifdef _WIN32
+    #include <iterator>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace utils {
+
+/**
+ * @brief Read-only view of a whole file, memory-mapped where the platform allows it.
+ *
+ * Without mmap (Windows) the file is read into a buffer instead.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() { Close(); }
+
+    /**
+     * @brief Maps a file.
+     *
+     * @param path
+     * @param sequential Hints the kernel that the file will be read once, front to back.
+     *
+     * @return false if the file cannot be opened.
+     */
+    inline bool Open(const std::string& path, bool sequential = true)
+    {
+        Close();
+
+#ifdef _WIN32
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        m_size = static_cast<size_t>(info.st_size);
+        if (m_size > 0)
+        {
+            // Read-only shared mapping: processes mapping the same file share its pages.
+            void* data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+            {
+                ::close(fd);
+                m_size = 0;
+                return false;
+            }
+
+            if (sequential)
+                ::madvise(data, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(data);
+            m_mapped = true;
+        }
+
+        ::close(fd);
+#endif
+        return true;
+    }
+
+    inline void Close()
+    {
+#ifndef _WIN32
+        if (m_mapped)
+            ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+        m_mapped = false;
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;
+    std::vector<char> m_buffer;
+};
+
+/**
+ * @brief Nodes of an instance and, for EXPLICIT instances, the edge weights.
+ *
+ * The depot is always the first node, with id 1, and ids follow the order of the nodes; when
+ * the DEPOT_SECTION names another node, the two are swapped.
+ */
+struct Instance
+{
+    std::vector<Node> nodes;
+    std::vector<double> weights;    // Full matrix, row-major; empty unless EDGE_WEIGHT_TYPE is EXPLICIT.
+    bool hasCoordinates = false;
+};
+
+namespace detail {
+
+/**
+ * @brief Tokenizer over the text of an instance, without copies or allocations.
+ */
+class InstanceScanner
+{
+public:
+    InstanceScanner(const char* begin, const char* end) : m_pos(begin), m_end(end) {}
+
+    bool done() const { return m_pos >= m_end; }
+
+    /**
+     * @brief Next non-empty line, trimmed.
+     */
+    inline std::string_view Line()
+    {
+        while (m_pos < m_end)
+        {
+            const char* newline = static_cast<const char*>(std::memchr(m_pos, '\n', m_end - m_pos));
+            const char* stop = newline ? newline : m_end;
+            std::string_view line = Trim(std::string_view(m_pos, stop - m_pos));
+            m_pos = newline ? newline + 1 : m_end;
+
+            if (!line.empty())
+                return line;
+        }
+
+        return std::string_view();
+    }
+
+    /**
+     * @brief Next number, across lines.
+     */
+    template <typename T>
+    inline T Number()
+    {
+        while (m_pos < m_end && IsSpace(*m_pos))
+            ++m_pos;
+
+        T value{};
+        auto result = std::from_chars(m_pos, m_end, value);
+        if (result.ec != std::errc())
+        {
+            const char* token = m_pos;
+            while (token < m_end && token - m_pos < 16 && !IsSpace(*token))
+                ++token;
+            throw std::runtime_error("Error: Expected a number in the instance, found \"" + std::string(m_pos, token) + "\".");
+        }
+
+        m_pos = result.ptr;
+        return value;
+    }
+
+    static inline std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && IsSpace(text.front()))
+            text.remove_prefix(1);
+        while (!text.empty() && IsSpace(text.back()))
+            text.remove_suffix(1);
+        return text;
+    }
+
+private:
+    const char* m_pos;
+    const char* m_end;
+
+    static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+};
+
+/**
+ * @brief Reads an EDGE_WEIGHT_SECTION into a full symmetric matrix.
+ */
+inline void ReadEdgeWeights(InstanceScanner& scanner, const std::string& format, size_t n, std::vector<double>& weights)
+{
+    weights.assign(n * n, 0.0);
+    auto set = [&weights, n](size_t i, size_t j, double w) { weights[i * n + j] = weights[j * n + i] = w; };
+
+    // Column formats of a symmetric matrix list the same numbers as the opposite row formats.
+    if (format == "FULL_MATRIX")
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                weights[i * n + j] = scanner.Number<double>();
+    }
+    else if (format == "UPPER_ROW" || format == "LOWER_COL")
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = i + 1; j < n; ++j)
+                set(i, j, scanner.Number<double>());
+    }
+    else if (format == "LOWER_ROW" || format == "UPPER_COL")
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < i; ++j)
+                set(i, j, scanner.Number<double>());
+    }
+    else if (format == "UPPER_DIAG_ROW" || format == "LOWER_DIAG_COL")
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = i; j < n; ++j)
+                set(i, j, scanner.Number<double>());
+    }
+    else if (format == "LOWER_DIAG_ROW" || format == "UPPER_DIAG_COL")
+    {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j <= i; ++j)
+                set(i, j, scanner.Number<double>());
+    }
+    else
+        throw std::runtime_error("Error: Unsupported EDGE_WEIGHT_FORMAT " + format + ".");
+}
+
+/**
+ * @brief Checks that the capacity is positive and that every customer fits in a vehicle.
+ *
+ * @param nodes Nodes of the instance, the depot first.
+ * @param capacity
+ *
+ * @throw std::runtime_error otherwise.
+ */
+inline void CheckCapacity(const std::vector<Node>& nodes, long capacity)
+{
+    if (capacity <= 0)
+        throw std::runtime_error("Error: The instance has no positive CAPACITY.");
+
+    for (size_t i = 1; i < nodes.size(); ++i)
+        if (nodes[i].getDemand() > capacity)
+            throw std::runtime_error("Error: Customer " + std::to_string(nodes[i].getId()) + " has a demand above the CAPACITY " +
+                                     std::to_string(capacity) + ".");
+}
+
+}
+
+/**
+ * @brief Reads a CVRPLIB (TSPLIB format) instance.
+ *
+ * The file is memory-mapped and parsed in place with from_chars. Understands the DIMENSION,
+ * CAPACITY, EDGE_WEIGHT_TYPE (EUC_2D or EXPLICIT) and EDGE_WEIGHT_FORMAT keys and the
+ * NODE_COORD_SECTION, DISPLAY_DATA_SECTION, DEMAND_SECTION, DEPOT_SECTION and
+ * EDGE_WEIGHT_SECTION sections. EXPLICIT instances take their distances from the
+ * EDGE_WEIGHT_SECTION (FULL_MATRIX and the row and column triangular formats); their
+ * coordinates, if any, come from DISPLAY_DATA_SECTION.
+ * Fills DIMENSION, CAPACITY and the maximum coordinates in the parameters.
+ *
+ * @param param Parameters with the path of the instance.
+ * @param instance Receives the instance; left empty if the file cannot be opened.
+ *
+ * @return false if the file cannot be opened.
+ * @throw std::runtime_error if the file is not a valid instance, has no positive CAPACITY or
+ * a customer whose demand exceeds it.
+ */
+inline bool ReadInstance(Parameters* param, Instance& instance)
+{
+    instance = Instance();
+
+    MappedFile file;
+    if (!file.Open(param->input_file))
+    {
+        std::cerr << "Error: Cannot open file " << param->input_file << std::endl;
+        return false;
+    }
+
+    detail::InstanceScanner scanner(file.data(), file.data() + file.size());
+    std::string weightType = "EUC_2D";
+    std::string weightFormat = "FULL_MATRIX";
+    size_t n = 0;
+    long capacity = 0;
+    int depot = 1;
+    bool hasDemands = false;
+
+    auto ensureNodes = [&]() {
+        if (n == 0)
+            throw std::runtime_error("Error: DIMENSION must come before the sections of the instance.");
+        if (instance.nodes.empty())
+            for (size_t i = 0; i < n; ++i)
+                instance.nodes.emplace_back(static_cast<int>(i) + 1, 0.0, 0.0, 0.0);
+    };
+
+    auto readValue = [](std::string_view key, const std::string& value) {
+        long result = 0;
+        auto parsed = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (parsed.ec != std::errc() || parsed.ptr != value.data() + value.size() || result < 0)
+            throw std::runtime_error("Error: Invalid " + std::string(key) + " \"" + value + "\" in the instance.");
+        return result;
+    };
+
+    auto readIndex = [&]() {
+        int id = scanner.Number<int>();
+        if (id < 1 || static_cast<size_t>(id) > n)
+            throw std::runtime_error("Error: Node " + std::to_string(id) + " out of range in the instance.");
+        return static_cast<size_t>(id - 1);
+    };
+
+    while (!scanner.done())
+    {
+        std::string_view line = scanner.Line();
+        if (line.empty() || line == "EOF")
+            break;
+
+        size_t colon = line.find(':');
+        std::string_view key = detail::InstanceScanner::Trim(line.substr(0, colon));
+
+        if (colon != std::string_view::npos)
+        {
+            std::string value(detail::InstanceScanner::Trim(line.substr(colon + 1)));
+
+            if (key == "DIMENSION")
+                n = static_cast<size_t>(readValue(key, value));
+            else if (key == "CAPACITY")
+                capacity = readValue(key, value);
+            else if (key == "EDGE_WEIGHT_TYPE")
+                weightType = value;
+            else if (key == "EDGE_WEIGHT_FORMAT")
+                weightFormat = value;
+
+            // Other keys (NAME, COMMENT, TYPE, ...) are ignored.
+            continue;
+        }
+
+        if (key == "NODE_COORD_SECTION" || key == "DISPLAY_DATA_SECTION")
+        {
+            ensureNodes();
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t index = readIndex();
+                instance.nodes[index].setX(scanner.Number<double>());
+                instance.nodes[index].setY(scanner.Number<double>());
+            }
+            instance.hasCoordinates = true;
+        }
+        else if (key == "DEMAND_SECTION")
+        {
+            ensureNodes();
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t index = readIndex();
+                instance.nodes[index].setDemand(scanner.Number<double>());
+            }
+            hasDemands = true;
+        }
+        else if (key == "DEPOT_SECTION")
+        {
+            // A list of depots ended by -1; only the first one is used.
+            depot = scanner.Number<int>();
+            if (depot != -1)
+                while (scanner.Number<int>() != -1) {}
+        }
+        else if (key == "EDGE_WEIGHT_SECTION")
+        {
+            ensureNodes();
+            detail::ReadEdgeWeights(scanner, weightFormat, n, instance.weights);
+        }
+        else
+            throw std::runtime_error("Error: Unknown section " + std::string(key) + " in the instance.");
+    }
+
+    if (instance.nodes.empty() || !hasDemands)
+        throw std::runtime_error("Error: The instance has no nodes or no DEMAND_SECTION.");
+
+    // Coordinates give Euclidean distances only; GEO, ATT, CEIL_2D and the like are refused
+    // rather than silently read as Euclidean.
+    if (weightType != "EUC_2D" && weightType != "EXPLICIT")
+        throw std::runtime_error("Error: Unsupported EDGE_WEIGHT_TYPE " + weightType + ", expected EUC_2D or EXPLICIT.");
+
+    if (weightType == "EXPLICIT")
+    {
+        if (instance.weights.empty())
+            throw std::runtime_error("Error: EXPLICIT instance without EDGE_WEIGHT_SECTION.");
+    }
+    else
+    {
+        instance.weights.clear();
+        if (!instance.hasCoordinates)
+            throw std::runtime_error("Error: The instance has no NODE_COORD_SECTION.");
+    }
+
+    // The rest of the code expects the depot first, with id 1.
+    if (depot < 1 || static_cast<size_t>(depot) > n)
+        throw std::runtime_error("Error: Depot " + std::to_string(depot) + " out of range in the instance.");
+
+    size_t d = static_cast<size_t>(depot - 1);
+    if (d != 0)
+    {
+        std::swap(instance.nodes[0], instance.nodes[d]);
+        instance.nodes[0].setId(1);
+        instance.nodes[d].setId(depot);
+
+        if (!instance.weights.empty())
+        {
+            for (size_t j = 0; j < n; ++j)
+                std::swap(instance.weights[j], instance.weights[d * n + j]);
+            for (size_t i = 0; i < n; ++i)
+                std::swap(instance.weights[i * n], instance.weights[i * n + d]);
+        }
+    }
+
+    detail::CheckCapacity(instance.nodes, capacity);
+
+    int max_x = 0;
+    int max_y = 0;
+    for (const Node& node : instance.nodes)
+    {
+        if (node.getX() > max_x) max_x = node.getX();
+        if (node.getY() > max_y) max_y = node.getY();
+    }
+
+    param->dimension = static_cast<int>(n);
+    param->capacity = static_cast<int>(capacity);
+    param->max_x = max_x;
+    param->max_y = max_y;
+
+    return true;
+}
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef NEIGHBOR_LISTS_H
+#define NEIGHBOR_LISTS_H
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "distance_matrix.hpp"
+#include "spatial_grid.hpp"
+
+/**
+ * @brief k-nearest customer lists of an instance (granular neighborhoods).
+ *
+ * For every node, keeps the k closest customers (the depot is never a neighbor), sorted by
+ * distance, in a single row-major buffer. The lists are not symmetric: v can be among the
+ * nearest of u without u being among the nearest of v. Local search, annealing and SWAP*
+ * only try a move between u and v when v is in the list of u.
+ */
+class NeighborLists
+{
+public:
+    NeighborLists() : m_size(0), m_k(0), m_stride(0), m_values(nullptr) {}
+
+    // A copy would point to the lists of the original.
+    NeighborLists(const NeighborLists&) = delete;
+    NeighborLists& operator=(const NeighborLists&) = delete;
+    NeighborLists(NeighborLists&&) = default;
+    NeighborLists& operator=(NeighborLists&&) = default;
+
+    NeighborLists(const DistanceMatrix& distances, int k)
+        : NeighborLists()
+    {
+        Build(distances, k);
+    }
+
+    NeighborLists(const std::vector<Node>& nodes, int k)
+        : NeighborLists()
+    {
+        Build(nodes, k);
+    }
+
+    /**
+     * @brief Computes the k nearest customers of every node.
+     *
+     * @param distances Distance matrix of the instance.
+     * @param k Number of neighbors per node, capped to the number of other customers.
+     */
+    inline void Build(const DistanceMatrix& distances, int k)
+    {
+        m_size = distances.size();
+        m_k = std::max(0, std::min(k, static_cast<int>(m_size) - 2));
+        m_neighbors.assign(m_size * m_k, 0);
+
+        std::vector<int> candidates;
+
+        for (size_t i = 0; i < m_size && m_k > 0; ++i)
+        {
+            const dist_t* row = distances.row(i);
+
+            candidates.clear();
+            for (size_t j = 1; j < m_size; ++j)
+                if (j != i)
+                    candidates.push_back(static_cast<int>(j));
+
+            auto closer = [row](int a, int b) { return row[a] < row[b]; };
+            std::partial_sort(candidates.begin(), candidates.begin() + m_k, candidates.end(), closer);
+            std::copy(candidates.begin(), candidates.begin() + m_k, m_neighbors.begin() + i * m_k);
+        }
+
+        m_stride = m_k;
+        m_values = m_neighbors.data();
+    }
+
+    /**
+     * @brief Computes the k nearest customers of every node from the coordinates, through a spatial grid.
+     *
+     * Gives the same lists as the matrix version for Euclidean distances (ties broken by node
+     * index), in about O(n k log k) instead of O(n^2).
+     *
+     * @param nodes Nodes of the instance, indexed as in the DNA (0 is the depot).
+     * @param k Number of neighbors per node, capped to the number of other customers.
+     */
+    inline void Build(const std::vector<Node>& nodes, int k)
+    {
+        m_size = nodes.size();
+        m_k = std::max(0, std::min(k, static_cast<int>(m_size) - 2));
+        m_neighbors.assign(m_size * m_k, 0);
+
+        m_stride = m_k;
+        m_values = m_neighbors.data();
+
+        if (m_k == 0)
+            return;
+
+        SpatialGrid grid(nodes);
+        grid.Remove(0);
+
+        std::vector<int> nearest;
+
+        for (size_t i = 0; i < m_size; ++i)
+        {
+            grid.KNearest(nodes[i].getX(), nodes[i].getY(), m_k, nearest, static_cast<int>(i));
+            std::copy(nearest.begin(), nearest.end(), m_neighbors.begin() + i * m_k);
+        }
+    }
+
+    /**
+     * @brief Neighbors of a node, closest first.
+     *
+     * @param i Node index.
+     *
+     * @return Pointer to the k neighbors of the node.
+     */
+    const int* of(int i) const { return m_values + i * m_stride; }
+
+    /**
+     * @brief Uses lists stored elsewhere (e.g. a memory-mapped cache) instead of owning them.
+     *
+     * @param values Row-major lists of `stride` neighbors per node, closest first; must stay
+     * valid while the lists are used.
+     * @param n Number of nodes.
+     * @param stride Number of neighbors stored per node.
+     * @param k Number of neighbors to expose, at most stride: the first k of each list.
+     */
+    inline void Attach(const int* values, size_t n, int stride, int k)
+    {
+        m_neighbors.clear();
+        m_size = n;
+        m_stride = stride;
+        m_k = std::min(k, stride);
+        m_values = values;
+    }
+
+    int k() const { return this->m_k; }
+    int stride() const { return this->m_stride; }
+    size_t size() const { return this->m_size; }
+
+private:
+    size_t m_size;
+    int m_k;
+    int m_stride;
+    std::vector<int> m_neighbors;
+    const int* m_values;    // m_neighbors, or the attached lists.
+};
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace utils {
+
+/**
+ * @brief xoshiro256** pseudo-random generator.
+ *
+ * Satisfies UniformRandomBitGenerator, so it can be used with std::shuffle and the standard
+ * distributions. jump() advances the state by 2^128 steps, which splits one seed into
+ * non-overlapping substreams.
+ */
+class Xoshiro256
+{
+public:
+    using result_type = uint64_t;
+
+    Xoshiro256() { Seed(0); }
+
+    explicit Xoshiro256(uint64_t seed) { Seed(seed); }
+
+    /**
+     * @brief Sets the state from a seed, expanded with splitmix64.
+     *
+     * @param seed
+     */
+    inline void Seed(uint64_t seed)
+    {
+        for (auto &word : m_state)
+        {
+            seed += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    inline result_type operator()()
+    {
+        uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+
+        return result;
+    }
+
+    /**
+     * @brief Advances the generator by 2^128 steps.
+     */
+    inline void Jump()
+    {
+        static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                         0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+        uint64_t s[4] = { 0, 0, 0, 0 };
+
+        for (uint64_t jump : JUMP)
+        {
+            for (int b = 0; b < 64; ++b)
+            {
+                if (jump & (uint64_t(1) << b))
+                    for (int i = 0; i < 4; ++i)
+                        s[i] ^= m_state[i];
+                (*this)();
+            }
+        }
+
+        for (int i = 0; i < 4; ++i)
+            m_state[i] = s[i];
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+private:
+    uint64_t m_state[4];
+
+    static inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+namespace detail {
+
+struct RngSeed
+{
+    std::atomic<uint64_t> seed{0};
+    std::atomic<uint64_t> epoch{1};
+};
+
+inline RngSeed &GlobalSeed()
+{
+    static RngSeed state;
+    return state;
+}
+
+struct ThreadRng
+{
+    Xoshiro256 generator;
+    uint64_t epoch = 0;
+    uint64_t stream = 0;
+    uint64_t seed = 0;
+    bool explicitStream = false;
+    bool explicitSeed = false;
+};
+
+inline ThreadRng &CurrentThreadRng()
+{
+    thread_local ThreadRng rng;
+    return rng;
+}
+
+inline void Reseed(ThreadRng &rng, uint64_t seed, uint64_t stream, uint64_t epoch)
+{
+    rng.generator.Seed(seed);
+    for (uint64_t i = 0; i < stream; ++i)
+        rng.generator.Jump();
+
+    rng.seed = seed;
+    rng.stream = stream;
+    rng.epoch = epoch;
+}
+
+}
+
+/**
+ * @brief Sets the seed of every generator returned by Rng().
+ *
+ * Each thread reseeds its generator from this seed on its next draw.
+ *
+ * @param seed
+ */
+inline void SetSeed(uint64_t seed)
+{
+    detail::GlobalSeed().seed.store(seed, std::memory_order_relaxed);
+    detail::GlobalSeed().epoch.fetch_add(1, std::memory_order_release);
+}
+
+inline uint64_t GetSeed()
+{
+    return detail::GlobalSeed().seed.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Restarts the generator of the calling thread at a given substream of the seed.
+ *
+ * Threads that are not OpenMP workers (or that need a specific stream) call this once before
+ * drawing numbers. Substreams are 2^128 draws apart.
+ *
+ * @param stream Index of the substream.
+ */
+inline void SetStream(uint64_t stream)
+{
+    detail::ThreadRng &rng = detail::CurrentThreadRng();
+    rng.explicitStream = true;
+    rng.explicitSeed = false;
+    detail::Reseed(rng, GetSeed(), stream, detail::GlobalSeed().epoch.load(std::memory_order_acquire));
+}
+
+/**
+ * @brief Gives the calling thread its own seed, independent of SetSeed.
+ *
+ * Used by threads that run a whole search of their own (a repetition or an island), so that
+ * concurrent searches do not share the global seed.
+ *
+ * @param seed
+ * @param stream Index of the substream of that seed.
+ */
+inline void SetThreadSeed(uint64_t seed, uint64_t stream = 0)
+{
+    detail::ThreadRng &rng = detail::CurrentThreadRng();
+    rng.explicitStream = true;
+    rng.explicitSeed = true;
+    detail::Reseed(rng, seed, stream, rng.epoch);
+}
+
+/**
+ * @brief Seed used by the generator of the calling thread.
+ */
+inline uint64_t GetThreadSeed()
+{
+    const detail::ThreadRng &rng = detail::CurrentThreadRng();
+    return rng.explicitSeed ? rng.seed : GetSeed();
+}
+
+/**
+ * @brief Generator of the calling thread.
+ *
+ * Unless SetStream was called, the substream is the OpenMP thread number, so runs with the
+ * same seed and thread count draw the same numbers.
+ *
+ * @return Reference to the thread-local generator.
+ */
+inline Xoshiro256 &Rng()
+{
+    detail::ThreadRng &rng = detail::CurrentThreadRng();
+    uint64_t epoch = detail::GlobalSeed().epoch.load(std::memory_order_acquire);
+
+    if (rng.epoch != epoch && !rng.explicitSeed)
+    {
+        uint64_t stream = rng.stream;
+#ifdef _OPENMP
+        if (!rng.explicitStream)
+            stream = omp_get_thread_num();
+#endif
+        detail::Reseed(rng, GetSeed(), stream, epoch);
+    }
+
+    return rng.generator;
+}
+
+}
+
+#endif
@@ -9,9 +9,23 @@
     #include <sys/stat.h>
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 #include "../src/Core/genetic_algorithm.hpp"
 #include "../src/Core/memetic_algorithm.hpp"
+#include "../src/Core/island_model.hpp"
+#include "simd_kernels.hpp"
+#include "instance_reader.hpp"
+#include "instance_cache.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 struct TestResult {
     double fitness;
@@ -65,15 +79,185 @@ getFileName(const std::string& filePath) {
     return fileName;
 }
 
+inline bool
+IsValidAlgorithm(const std::string& algorithm)
+{
+    return algorithm == "GA" || algorithm == "MA" || algorithm == "MA-LS" || algorithm == "MA-PT" || algorithm == "PT";
+}
+
+/**
+ * @brief Prints how many Split labels were computed and how many were reused by incremental evaluation.
+ */
+inline void
+PrintSplitWork()
+{
+    GA::SplitCounters counters = GA::GetSplitCounters();
+
+    std::cout << "Split positions (evaluated/reused): " << counters.evaluated << "/"
+              << counters.reused << std::endl;
+}
+
+/**
+ * @brief Prints how busy every thread of a pool was while it had work.
+ */
+inline void
+PrintThreadUtilization(const GA::TaskPool& pool)
+{
+    double elapsed = pool.getElapsed();
+
+    std::cout << "Thread utilization:" << std::endl;
+
+    for (int t = 0; t < pool.size(); ++t)
+    {
+        const GA::TaskPool::ThreadStats& stats = pool.getStats(t);
+        double utilization = elapsed > 0 ? 100.0 * stats.busy / elapsed : 0.0;
+
+        std::cout << "  " << t << ": " << std::fixed << std::setprecision(1) << utilization << "% "
+                  << std::defaultfloat << "(" << stats.tasks << " tasks, " << stats.stolen << " stolen)" << std::endl;
+    }
+}
+
+/**
+ * @brief An instance with its distance matrix and neighbor lists.
+ *
+ * For preprocessed instances, the matrix and the lists may point into the mapping of the file.
+ */
+struct LoadedInstance
+{
+    utils::MappedFile file;
+    utils::Instance instance;
+    DistanceMatrix distances;
+    NeighborLists neighbors;
+};
+
+/**
+ * @brief Reads the instance of the parameters, either a text instance or a preprocessed one.
+ *
+ * Instances without coordinates (EXPLICIT ones without DISPLAY_DATA_SECTION) drop the K-means
+ * and sweep constructors from the seeding, which need them.
+ *
+ * @return false if the instance cannot be read.
+ */
+inline bool
+LoadInstance(Parameters* param, LoadedInstance& loaded)
+{
+    try
+    {
+        utils::Instance& instance = loaded.instance;
+
+        // Customers are stored in genes of gene_t; checked before the matrix is built.
+        auto fitsGenes = [&instance]() {
+            if (instance.nodes.size() - 1 <= std::numeric_limits<gene_t>::max())
+                return true;
+
+            std::cerr << "Error: Instance too large for the gene type. Rebuild with USE_WIDE_GENES=1." << std::endl;
+            return false;
+        };
+
+        if (utils::IsInstanceCache(param->input_file))
+        {
+            if (!utils::ReadInstanceCache(param, loaded.file, instance, loaded.distances, loaded.neighbors) || !fitsGenes())
+                return false;
+        }
+        else
+        {
+            if (!utils::ReadInstance(param, instance) || !fitsGenes())
+                return false;
+
+            if (instance.weights.empty())
+            {
+                loaded.distances.Build(instance.nodes);
+                loaded.neighbors.Build(instance.nodes, param->neighbors);
+            }
+            else
+            {
+                loaded.distances.Build(instance.weights, instance.nodes.size());
+                loaded.neighbors.Build(loaded.distances, param->neighbors);
+            }
+        }
+
+        if (!instance.hasCoordinates)
+        {
+            param->seeding_kmeans = 0;
+            param->seeding_sweep = 0;
+            if (param->seeding_savings + param->seeding_random == 0)
+                param->seeding_savings = 1;
+        }
+
+        return true;
+    }
+    catch (const std::exception& error)
+    {
+        // Malformed instances throw from the reader.
+        std::cerr << error.what() << std::endl;
+        return false;
+    }
+}
+
+/**
+ * @brief Writes the preprocessed form of the instance (--preprocess), to be given as the dataset of later runs.
+ */
+inline void
+RunPreprocess(Parameters* param)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    LoadedInstance loaded;
+    if (!LoadInstance(param, loaded))
+        return;
+
+    if (!utils::WriteInstanceCache(param->preprocess, param, loaded.instance, loaded.distances, loaded.neighbors))
+        return;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    std::cout << "Dataset: " << getFileName(param->input_file) << std::endl
+              << "Preprocessed: " << param->preprocess << " (" << loaded.instance.nodes.size() << " nodes, "
+              << loaded.neighbors.k() << " neighbors)" << std::endl
+              << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl;
+}
+
 inline void
 RunSingleTest(Parameters* param)
 {
-    std::vector<Node> clientes = utils::ReadNodesFromFile(param);
+    utils::SetSeed(param->seed);
 
-    if (param->algorithm == "GA")
+    LoadedInstance loaded;
+    if (!LoadInstance(param, loaded))
+        return;
+
+    std::vector<Node>& clientes = loaded.instance.nodes;
+    const DistanceMatrix& distances = loaded.distances;
+    const NeighborLists& neighbors = loaded.neighbors;
+
+    if (param->islands > 1 && param->algorithm != "PT" && IsValidAlgorithm(param->algorithm))
+    {
+        GA::IslandModel islands;
+        islands.setNodes(clientes);
+        islands.setDistances(&distances);
+        islands.setNeighbors(&neighbors);
+        islands.setParameters(param);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        islands.Run();
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        std::cout << "Dataset: " << getFileName(param->input_file) << std::endl
+                  << "Seed: " << param->seed << std::endl
+                  << "Islands: " << islands.getIslands() << " (" << param->topology << ", best island "
+                  << islands.getBestIsland() << ")" << std::endl
+                  << "Best Fitness: " << islands.getPopulation().getBestFitness() << std::endl
+                  << "Generations: " << islands.getPopulation().getGeneration() << std::endl
+                  << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl;
+    }
+    else if (param->algorithm == "GA")
     {
         GA::GeneticAlgorithm ga;
         ga.setNodes(clientes);
+        ga.setDistances(&distances);
+        ga.setNeighbors(&neighbors);
         ga.setParameters(param);
 
         auto start = std::chrono::high_resolution_clock::now();
@@ -82,14 +266,25 @@ RunSingleTest(Parameters* param)
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
         std::cout << "Dataset: " << getFileName(param->input_file) << std::endl
+                  << "Seed: " << param->seed << std::endl
+                  << "SIMD kernels: " << utils::SimdLevelName(utils::GetSimdLevel()) << std::endl
                   << "Best Fitness: " << ga.getPopulation().getBestFitness() << std::endl
                   << "Generations: " << ga.getPopulation().getGeneration() << std::endl
-                  << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl;
+                  << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl
+                  << "Allocations (total/last generation): " << ga.getAllocations() << "/"
+                  << ga.getLastGenerationAllocations() << std::endl;
+
+        PrintThreadUtilization(ga.getPool());
+        PrintSplitWork();
+        std::cout << "Fitness cache (hits/misses): " << ga.getFitnessCache().getHits() << "/"
+                  << ga.getFitnessCache().getMisses() << std::endl;
     }
-    else if (param->algorithm == "MA")
+    else if (IsValidAlgorithm(param->algorithm))
     {
         MA::MemeticAlgorithm ma;
         ma.setNodes(clientes);
+        ma.setDistances(&distances);
+        ma.setNeighbors(&neighbors);
         ma.setParameters(param);
 
         auto start = std::chrono::high_resolution_clock::now();
@@ -98,19 +293,93 @@ RunSingleTest(Parameters* param)
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
         std::cout << "Dataset: " << getFileName(param->input_file) << std::endl
+                  << "Seed: " << param->seed << std::endl
+                  << "SIMD kernels: " << utils::SimdLevelName(utils::GetSimdLevel()) << std::endl
                   << "Best Fitness: " << ma.getPopulation().getBestFitness() << std::endl
                   << "Generations: " << ma.getPopulation().getGeneration() << std::endl
-                  << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl;
+                  << "Duration (ms/s): " << duration.count() << "ms/" << duration.count() / 1000000.0 << "s" << std::endl
+                  << "Allocations (total/last generation): " << ma.getAllocations() << "/"
+                  << ma.getLastGenerationAllocations() << std::endl;
+
+        PrintThreadUtilization(ma.getPool());
+        PrintSplitWork();
+        std::cout << "Fitness cache (hits/misses): " << ma.getFitnessCache().getHits() << "/"
+                  << ma.getFitnessCache().getMisses() << std::endl;
     }
     else
     {
-        std::cerr << "Invalid algorithm choice. Please specify either 'GA' or 'MA'." << std::endl;
+        std::cerr << "Invalid algorithm choice. Please specify 'GA', 'MA', 'MA-LS', 'MA-PT' or 'PT'." << std::endl;
     }
 }
 
+/**
+ * @brief Runs one repetition of the chosen algorithm.
+ *
+ * The random generators must already be seeded for the calling thread.
+ *
+ * @param threads Threads of the task pool; 0 takes them from the parameters.
+ *
+ * @return The best fitness and the duration of the run.
+ */
+inline TestResult
+RunRepetition(Parameters* param, std::vector<Node>& clientes, const DistanceMatrix& distances,
+              const NeighborLists& neighbors, int threads = 0)
+{
+    std::unique_ptr<GA::IslandModel> islands;
+    std::unique_ptr<GA::GeneticAlgorithm> algorithm;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    double fitness;
+
+    if (param->islands > 1 && param->algorithm != "PT")
+    {
+        islands.reset(new GA::IslandModel());
+        islands->setNodes(clientes);
+        islands->setDistances(&distances);
+        islands->setNeighbors(&neighbors);
+        islands->setParameters(param);
+
+        start = std::chrono::high_resolution_clock::now();
+        islands->Run();
+        fitness = islands->getPopulation().getBestFitness();
+    }
+    else
+    {
+        if (param->algorithm == "GA")
+            algorithm.reset(new GA::GeneticAlgorithm());
+        else
+            algorithm.reset(new MA::MemeticAlgorithm());
+
+        algorithm->setNodes(clientes);
+        algorithm->setDistances(&distances);
+        algorithm->setNeighbors(&neighbors);
+        algorithm->setParameters(param);
+        algorithm->setThreads(threads);
+
+        start = std::chrono::high_resolution_clock::now();
+        algorithm->Run();
+        fitness = algorithm->getPopulation().getBestFitness();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    TestResult result;
+    result.fitness = fitness;
+    result.time_ms = static_cast<double>(duration.count());
+    result.time_sec = duration.count() / 1000000.0;
+    return result;
+}
+
 inline void 
 RunTests(Parameters* param)
 {
+    if (!IsValidAlgorithm(param->algorithm))
+    {
+        std::cerr << "Invalid algorithm choice. Please specify 'GA', 'MA', 'MA-LS', 'MA-PT' or 'PT'." << std::endl;
+        return;
+    }
+
     SetupFolders(getFileName(param->input_file));
 
     std::string folder_name = getFileName(param->input_file);
@@ -123,44 +392,59 @@ RunTests(Parameters* param)
         return;
     }
 
-    std::vector<Node> clientes = utils::ReadNodesFromFile(param);
+    LoadedInstance loaded;
+    if (!LoadInstance(param, loaded))
+        return;
 
-    for (int i = 0; i < 10; ++i)
-    {
-        if (param->algorithm == "GA")
-        {
-            GA::GeneticAlgorithm ga;
-            ga.setNodes(clientes);
-            ga.setParameters(param);
+    std::vector<Node>& clientes = loaded.instance.nodes;
+    const DistanceMatrix& distances = loaded.distances;
+    const NeighborLists& neighbors = loaded.neighbors;
 
-            auto start = std::chrono::high_resolution_clock::now();
-            ga.Run();
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    // Repetition i always seeds its thread with param->seed + i, through the same call whatever
+    // the number of jobs. Jobs run their repetitions on a single thread and a lone job on the
+    // whole pool; the generational and PT modes reseed every task, so their results do not
+    // depend on the thread count and a repetition gives the same result whatever the number
+    // of jobs. The steady-state mode does depend on it.
+    int repetitions = std::max(1, param->repetitions);
+    int jobs = std::min(std::max(1, param->jobs), repetitions);
+    std::vector<TestResult> results(repetitions);
 
-            file << i + 1 << ": " << ga.getPopulation().getBestFitness() << " - " << duration.count()
-                 << "/" << duration.count() / 1000000.0 << std::endl;
-        }
-        else if (param->algorithm == "MA")
+    if (jobs == 1)
+    {
+        for (int i = 0; i < repetitions; ++i)
         {
-            MA::MemeticAlgorithm ma;
-            ma.setNodes(clientes);
-            ma.setParameters(param);
-
-            auto start = std::chrono::high_resolution_clock::now();
-            ma.Run();
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-            file << i + 1 << ": " << ma.getPopulation().getBestFitness() << " - " << duration.count()
-                 << "/" << duration.count() / 1000000.0 << std::endl;
+            utils::SetThreadSeed(param->seed + i);
+            results[i] = RunRepetition(param, clientes, distances, neighbors);
         }
-        else
+    }
+    else
+    {
+        // Every job takes the next repetition until none is left, running it on a single thread.
+        std::atomic<int> next(0);
+        std::vector<std::thread> workers;
+
+        for (int j = 0; j < jobs; ++j)
         {
-            std::cerr << "Invalid algorithm choice. Please specify either 'GA' or 'MA'." << std::endl;
-            break;
+            workers.emplace_back([&]()
+            {
+#ifdef _OPENMP
+                omp_set_num_threads(1);
+#endif
+                for (int i = next++; i < repetitions; i = next++)
+                {
+                    utils::SetThreadSeed(param->seed + i);
+                    results[i] = RunRepetition(param, clientes, distances, neighbors, 1);
+                }
+            });
         }
+
+        for (auto& worker : workers)
+            worker.join();
     }
+
+    for (int i = 0; i < repetitions; ++i)
+        file << i + 1 << ": " << results[i].fitness << " - " << static_cast<long long>(results[i].time_ms)
+             << "/" << results[i].time_sec << std::endl;
 }
 
 inline void
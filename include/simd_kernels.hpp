@@ -0,0 +1,75 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <cstddef>
+#include <string>
+
+namespace utils {
+
+/**
+ * @brief Instruction sets the distance kernels can run on.
+ */
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+/**
+ * @brief Best level supported by the processor (and by the build, on x86 only).
+ */
+SimdLevel DetectSimdLevel();
+
+/**
+ * @brief Level used by the kernels; the detected one unless SetSimdLevel chose another.
+ */
+SimdLevel GetSimdLevel();
+
+/**
+ * @brief Forces the level used by the kernels, capped to the detected one.
+ *
+ * @param level
+ */
+void SetSimdLevel(SimdLevel level);
+
+const char* SimdLevelName(SimdLevel level);
+
+/**
+ * @brief Parses "scalar", "avx2", "avx512" or "auto" (the detected level).
+ *
+ * @return false if the name is unknown.
+ */
+bool ParseSimdLevel(const std::string& name, SimdLevel& level);
+
+/**
+ * @brief Index of the point closest to (px, py), among points given as coordinate arrays (SoA).
+ *
+ * Compares squared distances, so no square root is taken. Ties go to the lowest index, on
+ * every level.
+ *
+ * @param xs X coordinates.
+ * @param ys Y coordinates.
+ * @param count Number of points, at least 1.
+ * @param px
+ * @param py
+ *
+ * @return The index of the closest point.
+ */
+size_t ArgminSquaredDistance(const double* xs, const double* ys, size_t count, double px, double py);
+
+/**
+ * @brief Assigns every point to its closest center (the K-means assignment step).
+ *
+ * Works across points, so the vector lanes stay busy even with few centers.
+ *
+ * @param xs X coordinates of the points.
+ * @param ys Y coordinates of the points.
+ * @param count Number of points.
+ * @param cx X coordinates of the centers.
+ * @param cy Y coordinates of the centers.
+ * @param k Number of centers, at least 1.
+ * @param assignment Receives the index of the closest center of each point; ties go to the
+ * lowest index.
+ */
+void AssignNearest(const double* xs, const double* ys, size_t count, const double* cx, const double* cy,
+                   size_t k, int* assignment);
+
+}
+
+#endif
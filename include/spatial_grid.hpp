@@ -0,0 +1,335 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "node.hpp"
+
+/**
+ * @brief Uniform grid over the coordinates of a set of points, with deletion.
+ *
+ * Points are bucketed by cell; each cell is a contiguous slice of coordinate arrays, with its
+ * live points first. Queries visit rings of cells around the query point and stop as soon as
+ * no farther ring can hold a closer point, which on uniformly spread points costs O(1) cells
+ * per query. A removal swaps the point out of the live part of its cell; when three quarters
+ * of the points are gone the grid is rebuilt over the remaining ones, so queries on an almost
+ * empty grid do not walk over empty cells.
+ *
+ * Points are identified by their index in the arrays given to Build. Among points at the same
+ * distance the lowest index wins.
+ */
+class SpatialGrid
+{
+public:
+    SpatialGrid() : m_minX(0), m_minY(0), m_cellSize(1), m_cols(0), m_rows(0), m_live(0), m_built(0) {}
+
+    /**
+     * @brief Indexes every node of an instance, the depot included.
+     */
+    explicit SpatialGrid(const std::vector<Node>& nodes)
+        : SpatialGrid()
+    {
+        std::vector<double> xs, ys;
+        for (const Node& node : nodes)
+        {
+            xs.push_back(node.getX());
+            ys.push_back(node.getY());
+        }
+
+        Build(xs.data(), ys.data(), nodes.size());
+    }
+
+    /**
+     * @brief Indexes a set of points, all live.
+     *
+     * @param xs X coordinates.
+     * @param ys Y coordinates.
+     * @param count Number of points.
+     */
+    inline void Build(const double* xs, const double* ys, size_t count)
+    {
+        this->m_slot.assign(count, -1);
+        this->m_ids.resize(count);
+        for (size_t i = 0; i < count; ++i)
+            this->m_ids[i] = static_cast<int>(i);
+
+        this->m_xs.assign(xs, xs + count);
+        this->m_ys.assign(ys, ys + count);
+
+        Bucket();
+    }
+
+    bool contains(int point) const { return this->m_slot[point] >= 0; }
+    size_t size() const { return this->m_live; }
+    bool empty() const { return this->m_live == 0; }
+
+    /**
+     * @brief Removes a live point from the grid.
+     *
+     * @param point Index of the point.
+     */
+    inline void Remove(int point)
+    {
+        int slot = this->m_slot[point];
+        int cell = Cell(this->m_xs[slot], this->m_ys[slot]);
+        int last = this->m_cellStart[cell] + --this->m_cellLive[cell];
+
+        Exchange(slot, last);
+        this->m_slot[point] = -1;
+
+        if (--this->m_live * 4 < this->m_built && this->m_live > 0)
+            Compact();
+    }
+
+    /**
+     * @brief Closest live point to (x, y).
+     *
+     * @return The index of the point, or -1 if the grid is empty.
+     */
+    inline int Nearest(double x, double y) const
+    {
+        int best = -1;
+        double bestDistance = std::numeric_limits<double>::infinity();
+
+        if (this->m_live == 0)
+            return best;
+
+        int col = Column(x);
+        int row = Row(y);
+        int rings = std::max(this->m_cols, this->m_rows);
+
+        for (int r = 0; r <= rings; ++r)
+        {
+            VisitRing(col, row, r, [&](int slot) {
+                double distance = SquaredDistance(slot, x, y);
+                int id = this->m_ids[slot];
+                if (distance < bestDistance || (distance == bestDistance && id < best))
+                {
+                    bestDistance = distance;
+                    best = id;
+                }
+            });
+
+            // Points in the next rings are at least r cells away from the query point.
+            double reach = r * this->m_cellSize;
+            if (best >= 0 && bestDistance < reach * reach)
+                break;
+        }
+
+        return best;
+    }
+
+    /**
+     * @brief The k closest live points to (x, y), closest first.
+     *
+     * @param x
+     * @param y
+     * @param k Number of points; fewer are returned if the grid holds fewer.
+     * @param result Receives the indices of the points.
+     * @param exclude Index of a point to leave out (typically the query point itself), or -1.
+     */
+    inline void KNearest(double x, double y, int k, std::vector<int>& result, int exclude = -1) const
+    {
+        // Max-heap of the best candidates so far, worst on top.
+        thread_local std::vector<std::pair<double, int>> heap;
+        heap.clear();
+        result.clear();
+
+        if (k <= 0 || this->m_live == 0)
+            return;
+
+        int col = Column(x);
+        int row = Row(y);
+        int rings = std::max(this->m_cols, this->m_rows);
+
+        for (int r = 0; r <= rings; ++r)
+        {
+            VisitRing(col, row, r, [&](int slot) {
+                int id = this->m_ids[slot];
+                if (id == exclude)
+                    return;
+
+                std::pair<double, int> candidate(SquaredDistance(slot, x, y), id);
+                if (heap.size() < static_cast<size_t>(k))
+                {
+                    heap.push_back(candidate);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else if (candidate < heap.front())
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = candidate;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            });
+
+            double reach = r * this->m_cellSize;
+            if (heap.size() == static_cast<size_t>(k) && heap.front().first < reach * reach)
+                break;
+        }
+
+        std::sort_heap(heap.begin(), heap.end());
+        for (const auto& candidate : heap)
+            result.push_back(candidate.second);
+    }
+
+private:
+    double m_minX;
+    double m_minY;
+    double m_cellSize;
+    int m_cols;
+    int m_rows;
+    size_t m_live;
+    size_t m_built;
+
+    // Points in cell order; the live points of cell c are the first m_cellLive[c] from m_cellStart[c].
+    std::vector<int> m_ids;
+    std::vector<double> m_xs;
+    std::vector<double> m_ys;
+    std::vector<int> m_slot;        // Slot of each point, or -1 once removed.
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellLive;
+
+    /**
+     * @brief Drops the removed points and buckets the remaining ones again.
+     */
+    inline void Compact()
+    {
+        size_t live = 0;
+        for (size_t slot = 0; slot < this->m_ids.size(); ++slot)
+        {
+            if (this->m_slot[this->m_ids[slot]] < 0)
+                continue;
+
+            this->m_ids[live] = this->m_ids[slot];
+            this->m_xs[live] = this->m_xs[slot];
+            this->m_ys[live] = this->m_ys[slot];
+            live++;
+        }
+
+        this->m_ids.resize(live);
+        this->m_xs.resize(live);
+        this->m_ys.resize(live);
+
+        Bucket();
+    }
+
+    /**
+     * @brief Sizes the grid for the points in the arrays (about two per cell) and sorts them by cell.
+     */
+    inline void Bucket()
+    {
+        size_t live = this->m_ids.size();
+        this->m_live = this->m_built = live;
+
+        double maxX = 0, maxY = 0;
+        this->m_minX = this->m_minY = 0;
+        if (live > 0)
+        {
+            auto xs = std::minmax_element(this->m_xs.begin(), this->m_xs.end());
+            auto ys = std::minmax_element(this->m_ys.begin(), this->m_ys.end());
+            this->m_minX = *xs.first;
+            this->m_minY = *ys.first;
+            maxX = *xs.second;
+            maxY = *ys.second;
+        }
+
+        double width = maxX - this->m_minX;
+        double height = maxY - this->m_minY;
+        double cells = std::max(1.0, live / 2.0);
+
+        if (width > 0 && height > 0)
+            this->m_cellSize = std::sqrt(width * height / cells);
+        else
+            this->m_cellSize = std::max(width, height) / cells;
+        if (!(this->m_cellSize > 0))
+            this->m_cellSize = 1;
+
+        this->m_cols = static_cast<int>(width / this->m_cellSize) + 1;
+        this->m_rows = static_cast<int>(height / this->m_cellSize) + 1;
+
+        // Counting sort of the points by cell.
+        size_t cellCount = static_cast<size_t>(this->m_cols) * this->m_rows;
+        this->m_cellStart.assign(cellCount + 1, 0);
+        this->m_cellLive.assign(cellCount, 0);
+
+        std::vector<int> cellOf(live);
+        for (size_t i = 0; i < live; ++i)
+        {
+            cellOf[i] = Cell(this->m_xs[i], this->m_ys[i]);
+            this->m_cellLive[cellOf[i]]++;
+        }
+
+        for (size_t c = 0; c < cellCount; ++c)
+            this->m_cellStart[c + 1] = this->m_cellStart[c] + this->m_cellLive[c];
+
+        std::vector<int> ids(live);
+        std::vector<double> xs(live), ys(live);
+        std::vector<int> next(this->m_cellStart.begin(), this->m_cellStart.end() - 1);
+
+        for (size_t i = 0; i < live; ++i)
+        {
+            int slot = next[cellOf[i]]++;
+            ids[slot] = this->m_ids[i];
+            xs[slot] = this->m_xs[i];
+            ys[slot] = this->m_ys[i];
+            this->m_slot[ids[slot]] = slot;
+        }
+
+        this->m_ids.swap(ids);
+        this->m_xs.swap(xs);
+        this->m_ys.swap(ys);
+    }
+
+    inline void Exchange(int a, int b)
+    {
+        std::swap(this->m_ids[a], this->m_ids[b]);
+        std::swap(this->m_xs[a], this->m_xs[b]);
+        std::swap(this->m_ys[a], this->m_ys[b]);
+        this->m_slot[this->m_ids[a]] = a;
+        this->m_slot[this->m_ids[b]] = b;
+    }
+
+    /**
+     * @brief Calls visit(slot) for every live point in the cells at Chebyshev distance r of (col, row).
+     */
+    template <typename Visit>
+    inline void VisitRing(int col, int row, int r, Visit&& visit) const
+    {
+        int top = row - r, bottom = row + r;
+        int left = col - r, right = col + r;
+
+        for (int y = std::max(top, 0); y <= std::min(bottom, this->m_rows - 1); ++y)
+        {
+            bool edge = (y == top || y == bottom);
+            int step = edge ? 1 : 2 * r;
+
+            for (int x = left; x <= right; x += step)
+            {
+                if (x >= 0 && x < this->m_cols)
+                {
+                    int cell = y * this->m_cols + x;
+                    int first = this->m_cellStart[cell];
+                    for (int slot = first; slot < first + this->m_cellLive[cell]; ++slot)
+                        visit(slot);
+                }
+            }
+        }
+    }
+
+    inline double SquaredDistance(int slot, double x, double y) const
+    {
+        double dx = this->m_xs[slot] - x;
+        double dy = this->m_ys[slot] - y;
+        return dx * dx + dy * dy;
+    }
+
+    int Column(double x) const { return std::min(std::max(static_cast<int>((x - this->m_minX) / this->m_cellSize), 0), this->m_cols - 1); }
+    int Row(double y) const { return std::min(std::max(static_cast<int>((y - this->m_minY) / this->m_cellSize), 0), this->m_rows - 1); }
+    int Cell(double x, double y) const { return Row(y) * this->m_cols + Column(x); }
+};
+
+#endif
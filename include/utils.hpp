@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include "node.hpp"
+#include "rng.hpp"
 #include "../src/parameters.hpp"
 
 namespace utils {
@@ -15,7 +16,7 @@ namespace utils {
  * @brief Generate a random number between min and max (inclusive)
  * 
  * This function generates a random integer within the specified range, including both
- * the minimun and maximun values.
+ * the minimun and maximun values, from the generator of the calling thread.
  * 
  * @param min The minimun value (inclusive) of the range.
  * @param max The maximun value (inclusive) of the range.
@@ -23,18 +24,18 @@ namespace utils {
  */
 inline int randInteger(int min, int max)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> distr(min, max);
+    // Multiply-shift range reduction (Lemire) on the high 32 bits of a draw.
+    uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+    uint64_t draw = Rng()() >> 32;
 
-    return distr(gen);
+    return static_cast<int>(min + static_cast<int64_t>((draw * range) >> 32));
 }
 
 /**
  * @brief Generate a random number between min and max (inclusive)
  * 
  * This function generates a random double within the specified range, including both
- * the minimun and maximun values.
+ * the minimun and maximun values, from the generator of the calling thread.
  * 
  * @param min The minimun value (inclusive) of the range.
  * @param max The maximun value (inclusive) of the range.
@@ -42,11 +43,9 @@ inline int randInteger(int min, int max)
  */
 inline double randDouble(double min, double max)
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> distr(min, max);
+    double unit = (Rng()() >> 11) * 0x1.0p-53;
 
-    return distr(gen);
+    return min + unit * (max - min);
 }
 
 /**
@@ -72,118 +71,6 @@ inline double Distance(const Node& a, const Node& b)
         a.getY(), b.getY());
 }
 
-/**
- * @brief Remove leading and trailing whitespace characters from a string.
- * 
- * This function removes any leading (beginning) and trailing (end) spaces, tabs, newlines, 
- * and carriage return characters from the input string.
- * 
- * @param str The input string to be trimmed.
- * 
- * @return A new string with leading and trailing whitespace removed.
- */
-inline std::string Trim(const std::string& str)
-{
-    size_t first = str.find_first_not_of(" \t\n\r");
-    size_t last = str.find_last_not_of(" \t\n\r");
-    return (first == std::string::npos || last == std::string::npos) ? "" : str.substr(first, last - first + 1);
-}
-
-/**
- * @brief Reads nodes and associated data from a file.
- * 
- * This function reads node coordinates and demands from a file in a specific format.
- * It populates a vector of Node objects, each containing an ID, coordinates, and demand.
- * 
- * @param filename The name of the file to read.
- * @param values A reference to an unordered_map that will store additional parameters 
- * (e.g., DIMENSION, CAPACITY) found in the file.
- * 
- * @return A vector of Node objects populated with data from the file.
- */
-inline std::vector<Node> ReadNodesFromFile(Parameters* param)
-{
-    std::ifstream infile(param->input_file);
-    std::string line;
-    std::vector<Node> nodes;
-
-    if (!infile)
-    {
-        std::cerr << "Error: Cannot open file " << param->input_file << std::endl;
-        return nodes;
-    }
-
-    int max_x = 0;
-    int max_y = 0;
-    bool reading_coords = false;
-    bool reading_demands = false;
-    std::vector<double> demands;
-
-    while (std::getline(infile, line))
-    {
-        line = Trim(line);
-
-        std::istringstream iss(line);
-
-        if (line.find("DIMENSION") != std::string::npos || line.find("CAPACITY") != std::string::npos)
-        {
-            int value;
-            char colon;
-            std::string key;
-            
-            iss >> key >> colon >> value;
-            
-            if (key == "DIMENSION")
-                param->dimension = value;
-            if (key == "CAPACITY")
-                param->capacity = value;
-        }
-
-        if (line == "NODE_COORD_SECTION")
-        {
-            reading_coords = true;
-            continue;
-        }
-
-        if (line == "DEMAND_SECTION")
-        {
-            reading_coords = false;
-            reading_demands = true;
-            continue;
-        }
-
-        if (line == "DEPOT_SECTION" || line == "EOF")
-            break;
-
-        if (reading_coords)
-        {
-            int id;
-            double x, y;
-
-            iss >> id >> x >> y;
-            nodes.push_back(Node(id, x, y, 0.0));
-
-            if (x > max_x) max_x = x;
-            if (y > max_y) max_y = y;
-        }
-
-        if (reading_demands)
-        {
-            int id;
-            double demand;
-
-            iss >> id >> demand;
-            nodes[id - 1].setDemand(demand);
-        }
-    }
-
-    param->max_x = max_x;
-    param->max_y = max_y;
-
-    infile.close();
-    return nodes;
-}
-
 }
 
 #endif
\ No newline at end of file
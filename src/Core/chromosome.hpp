@@ -2,11 +2,163 @@
 #define CHROMOSOME_H
 #include <iostream>
 #include <vector>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include "node.hpp"
 #include "utils.hpp"
+#include "distance_matrix.hpp"
+
+#ifdef GENE32
+using gene_t = uint32_t;
+#else
+using gene_t = uint16_t;
+#endif
 
 namespace GA
 {
+    /**
+     * @brief A route of a chromosome, stored as the half-open range [begin, end) of its DNA.
+     */
+    struct Route
+    {
+        uint32_t begin;
+        uint32_t end;
+        double load;
+        double cost;
+
+        size_t size() const { return end - begin; }
+    };
+
+    /**
+     * @brief Split labels of a giant tour, kept to re-evaluate it after a local change.
+     *
+     * Entry t of each buffer describes the prefix made of the first t genes: its best split
+     * cost (potential), its tour length and load, and the predecessor of t in the best split.
+     * These entries only depend on that prefix, so after genes change from some position on,
+     * the entries up to that position can be reused.
+     */
+    struct SplitLabels
+    {
+        std::vector<double> potential;
+        std::vector<double> sumDistance;
+        std::vector<double> sumLoad;
+        std::vector<int> pred;
+        std::vector<int> queue;
+
+        inline void reserve(size_t n)
+        {
+            potential.resize(n + 1);
+            sumDistance.resize(n + 1);
+            sumLoad.resize(n + 1);
+            pred.resize(n + 1);
+            queue.resize(n + 1);
+        }
+
+        /**
+         * @brief Copies the entries of the first `genes` genes of other labels.
+         */
+        inline void copyPrefix(const SplitLabels &other, size_t genes)
+        {
+            reserve(other.potential.size() - 1);
+            std::copy(other.potential.begin(), other.potential.begin() + genes + 1, potential.begin());
+            std::copy(other.sumDistance.begin(), other.sumDistance.begin() + genes + 1, sumDistance.begin());
+            std::copy(other.sumLoad.begin(), other.sumLoad.begin() + genes + 1, sumLoad.begin());
+            std::copy(other.pred.begin(), other.pred.begin() + genes + 1, pred.begin());
+        }
+    };
+
+    /**
+     * @brief Work done by Split since the program started.
+     */
+    struct SplitCounters
+    {
+        unsigned long long evaluated = 0;   // Positions whose label was computed.
+        unsigned long long reused = 0;      // Positions whose label was reused.
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Counters of one thread, on a cache line of their own.
+         *
+         * Only the owning thread writes them; the atomics let GetSplitCounters read them while it
+         * runs, with plain loads and stores on the hot path.
+         */
+        struct alignas(64) ThreadSplitCounters
+        {
+            std::atomic<unsigned long long> evaluated{0};
+            std::atomic<unsigned long long> reused{0};
+
+            ThreadSplitCounters();
+            ~ThreadSplitCounters();
+
+            inline void add(size_t evaluatedPositions, size_t reusedPositions)
+            {
+                evaluated.store(evaluated.load(std::memory_order_relaxed) + evaluatedPositions, std::memory_order_relaxed);
+                reused.store(reused.load(std::memory_order_relaxed) + reusedPositions, std::memory_order_relaxed);
+            }
+        };
+
+        /**
+         * @brief Counters of the live threads, and the totals of the threads that have exited.
+         */
+        struct SplitCounterRegistry
+        {
+            std::mutex mutex;
+            std::vector<const ThreadSplitCounters *> threads;
+            SplitCounters exited;
+        };
+
+        inline SplitCounterRegistry &GetSplitCounterRegistry()
+        {
+            static SplitCounterRegistry registry;
+            return registry;
+        }
+
+        inline ThreadSplitCounters::ThreadSplitCounters()
+        {
+            SplitCounterRegistry &registry = GetSplitCounterRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threads.push_back(this);
+        }
+
+        inline ThreadSplitCounters::~ThreadSplitCounters()
+        {
+            SplitCounterRegistry &registry = GetSplitCounterRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.exited.evaluated += evaluated.load(std::memory_order_relaxed);
+            registry.exited.reused += reused.load(std::memory_order_relaxed);
+            registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+        }
+
+        inline ThreadSplitCounters &CurrentSplitCounters()
+        {
+            thread_local ThreadSplitCounters counters;
+            return counters;
+        }
+    }
+
+    /**
+     * @brief Work done by Split since the program started, summed over every thread.
+     */
+    inline SplitCounters GetSplitCounters()
+    {
+        detail::SplitCounterRegistry &registry = detail::GetSplitCounterRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+
+        SplitCounters total = registry.exited;
+        for (const detail::ThreadSplitCounters *counters : registry.threads)
+        {
+            total.evaluated += counters->evaluated.load(std::memory_order_relaxed);
+            total.reused += counters->reused.load(std::memory_order_relaxed);
+        }
+
+        return total;
+    }
+
     /**
      * @brief Represents a Chromosome in a genetic algorithm.
      *
@@ -14,42 +166,111 @@ namespace GA
      * as a vector of integers. The fitness value indicates how well this chromosome
      * performs with respect to a particular fitness function, while the DNA vector
      * represents the sequence of genes that define the chromosome's characteristics.
+     *
+     * The routes found by Split are consecutive segments of the DNA, so they are kept as
+     * offsets into it together with their load and cost. Every member is a flat buffer of
+     * trivially copyable values, so copying a chromosome is a plain memory copy.
+     *
+     * The chromosome also keeps a Zobrist-style hash of its DNA: the sum of one pseudo-random key
+     * per (position, gene) pair. Swapping two genes updates the hash in constant time.
      */
     class Chromosome
     {
     public:
-        Chromosome() : m_fitness(0.0), m_dna() {}
+        Chromosome() : m_fitness(0.0), m_dna(), m_hash(0) {}
 
-        Chromosome(double fitness, const std::vector<int> &dna)
-            : m_fitness(fitness), m_dna(dna) {}
+        Chromosome(double fitness, const std::vector<gene_t> &dna)
+            : m_fitness(fitness), m_dna(dna), m_hash(HashDNA(dna)) {}
 
-        bool operator == (const Chromosome &other) const { return this->m_dna == other.m_dna; }
+        bool operator == (const Chromosome &other) const
+        {
+            return this->m_hash == other.m_hash && this->m_dna == other.m_dna;
+        }
+
+        /**
+         * @brief Swaps two genes of the DNA, updating the hash incrementally.
+         *
+         * @param i Position of the first gene.
+         * @param j Position of the second gene.
+         */
+        inline void swapGenes(size_t i, size_t j)
+        {
+            gene_t a = this->m_dna[i];
+            gene_t b = this->m_dna[j];
+
+            this->m_hash += GeneKey(i, b) + GeneKey(j, a) - GeneKey(i, a) - GeneKey(j, b);
+            this->m_dna[i] = b;
+            this->m_dna[j] = a;
+        }
+
+        /**
+         * @brief Overwrites a segment of the DNA, updating the hash in O(count).
+         *
+         * @param begin Position of the first gene to overwrite.
+         * @param genes New genes.
+         * @param count Number of genes.
+         */
+        inline void setGenes(size_t begin, const gene_t* genes, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                size_t pos = begin + i;
+                this->m_hash += GeneKey(pos, genes[i]) - GeneKey(pos, this->m_dna[pos]);
+                this->m_dna[pos] = genes[i];
+            }
+        }
+
+        /**
+         * @brief Hash of a DNA sequence, equal to the hash a chromosome with that DNA keeps.
+         *
+         * @param dna
+         */
+        static inline uint64_t HashDNA(const std::vector<gene_t> &dna)
+        {
+            uint64_t hash = 0;
+            for (size_t i = 0; i < dna.size(); ++i)
+                hash += GeneKey(i, dna[i]);
+            return hash;
+        }
 
         /**
          * @brief Calculate the firness of an Individual.
          * 
          * @param nodes
+         * @param distances
          * @param capacity
          */
-        inline void CalculateFitness(const std::vector<Node>& nodes, int capacity)
+        inline void CalculateFitness(const std::vector<Node>& nodes, const DistanceMatrix& distances, int capacity)
         {
-            updateRoutes(nodes, capacity);
+            CalculateFitness(nodes, distances, capacity, splitBuffers(), 0);
+        }
+
+        /**
+         * @brief Calculate the fitness of an Individual, reusing the Split labels of its unchanged prefix.
+         *
+         * @param nodes
+         * @param distances
+         * @param capacity
+         * @param labels Labels of a DNA whose first `unchanged` genes are those of this DNA (for
+         * instance the DNA before a mutation); receives the labels of this DNA.
+         * @param unchanged Number of leading genes that did not change; 0 evaluates from scratch.
+         */
+        inline void CalculateFitness(const std::vector<Node>& nodes, const DistanceMatrix& distances, int capacity,
+                                     SplitLabels& labels, size_t unchanged)
+        {
+            // A customer alone exceeds the capacity: no split is feasible, and the chromosome
+            // gets an infinite cost and no routes.
+            if (!Split(nodes, distances, capacity, labels, std::min(unchanged, m_dna.size())))
+            {
+                m_routes.clear();
+                this->setFitness(std::numeric_limits<double>::infinity());
+                return;
+            }
 
             double fitness = 0.0;
             
             for (const auto& route : m_routes)
-            {
-                double routeCost = 0.0;
-
-                routeCost += utils::Distance(nodes[0], nodes[route[0]]);
-
-                for (size_t i = 0; i < route.size() - 1; ++i)
-                    routeCost += utils::Distance(nodes[route[i]], nodes[route[i + 1]]);
-
-                routeCost += utils::Distance(nodes[route.back()], nodes[0]);
-
-                fitness += routeCost;
-            }
+                fitness += route.cost;
 
             this->setFitness(fitness);
         }
@@ -58,36 +279,193 @@ namespace GA
         double getFitness() const { return this->m_fitness; }
         void setFitness(double fitness) { this->m_fitness = fitness; }
 
-        std::vector<int> &getDNA() { return this->m_dna; }
-        void setDNA(const std::vector<int> &dna) { this->m_dna = dna; }
+        const std::vector<gene_t> &getDNA() const { return this->m_dna; }
+        void setDNA(const std::vector<gene_t> &dna)
+        {
+            this->m_dna = dna;
+            this->m_hash = HashDNA(this->m_dna);
+        }
+
+        uint64_t getHash() const { return this->m_hash; }
 
-        std::vector<std::vector<int>> &getRoutes() { return this->m_routes; }
-        void setRoutes(const std::vector<std::vector<int>> &routes)
-        { 
-            this->m_routes = routes;
-            this->m_dna.clear();
-            for (const auto& route : this->m_routes)
-                for (int c : route)
-                    this->m_dna.push_back(c);
+        const std::vector<Route> &getRoutes() const { return this->m_routes; }
+
+        /**
+         * @brief Sets the fitness and routes of the DNA from a previous evaluation of the same DNA.
+         *
+         * @param fitness
+         * @param routes Routes found by Split for this DNA.
+         * @param count Number of routes.
+         */
+        void setEvaluation(double fitness, const Route *routes, size_t count)
+        {
+            this->m_fitness = fitness;
+            this->m_routes.assign(routes, routes + count);
         }
 
+        /**
+         * @brief Genes of a route.
+         *
+         * @param route A route of this chromosome.
+         *
+         * @return Pointer to the first gene of the route.
+         */
+        const gene_t* routeGenes(const Route &route) const { return this->m_dna.data() + route.begin; }
+
     private:
         double m_fitness;
-        std::vector<int> m_dna;
-        std::vector<std::vector<int>> m_routes;
+        std::vector<gene_t> m_dna;
+        std::vector<Route> m_routes;
+        uint64_t m_hash;
+
+        /**
+         * @brief Zobrist key of a gene at a given position (splitmix64 finalizer).
+         */
+        static inline uint64_t GeneKey(size_t position, gene_t gene)
+        {
+            uint64_t z = (static_cast<uint64_t>(position) << 32) ^ static_cast<uint32_t>(gene);
+            z += 0x9e3779b97f4a7c15ULL;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
 
-        inline void updateRoutes(const std::vector<Node>& nodes, int capacity)
+        /**
+         * @brief Scratch labels reused by Split on each thread.
+         *
+         * The buffers only grow, so after the first calls Split does not allocate.
+         */
+        static SplitLabels& splitBuffers()
+        {
+            thread_local SplitLabels buffers;
+            return buffers;
+        }
+
+        /**
+         * @brief Linear Split of the giant tour into capacity-feasible routes.
+         *
+         * Keeps the candidate predecessors in a deque ordered by potential. Predecessors are
+         * dropped from the back when dominated by a newer one and from the front when the
+         * route to the next customer would exceed the capacity, so each position enters and
+         * leaves the deque once.
+         *
+         * When the labels of the first `unchanged` genes are known, the deque is rebuilt from
+         * the predecessors that can still reach the next position within the capacity (at most
+         * one route back), and the recursion resumes from there.
+         *
+         * @param nodes
+         * @param distances
+         * @param capacity
+         * @param buf Labels, valid for the first `unchanged` genes.
+         * @param unchanged
+         *
+         * @return false if a single customer exceeds the capacity.
+         */
+        inline bool Split(const std::vector<Node>& nodes, const DistanceMatrix& distances, int capacity,
+                          SplitLabels& buf, size_t unchanged)
         {
-            Split(nodes, capacity);
+            size_t n = m_dna.size();
+            buf.reserve(n);
+
+            double* p = buf.potential.data();
+            double* D = buf.sumDistance.data();
+            double* Q = buf.sumLoad.data();
+            int* pred = buf.pred.data();
+            int* queue = buf.queue.data();
+
+            // Entries 0..m are kept: they only depend on the unchanged genes.
+            size_t m = (unchanged > 0 && unchanged < n) ? unchanged : 0;
+
+            // Customer t (1-based) is m_dna[t - 1]; D[t] is the tour length from customer 1 to t.
+            D[0] = 0;
+            Q[0] = 0;
+            for (size_t t = m + 1; t <= n; ++t)
+            {
+                D[t] = (t > 1) ? D[t - 1] + distances(m_dna[t - 2], m_dna[t - 1]) : 0;
+                Q[t] = Q[t - 1] + nodes[m_dna[t - 1]].getDemand();
+            }
+
+            // Potential of starting a route after position i, without the tour length to its end.
+            auto label = [&](int i) { return p[i] + distances(0, m_dna[i]) - D[i + 1]; };
+
+            int front = 0, back = 0;
+            queue[0] = 0;
+            p[0] = 0;
+
+            if (m > 0)
+            {
+                // Predecessors i <= m whose route can still take customer m + 1, as suffix minima of their labels.
+                back = -1;
+                for (size_t i = std::lower_bound(Q, Q + m + 1, Q[m + 1] - capacity) - Q; i <= m; ++i)
+                {
+                    double labelI = label(static_cast<int>(i));
+                    while (back >= front && labelI <= label(queue[back]))
+                        --back;
+                    queue[++back] = static_cast<int>(i);
+                }
+
+                if (front > back)
+                    return false;
+            }
+
+            detail::CurrentSplitCounters().add(n - m, m);
+
+            for (size_t t = m + 1; t <= n; ++t)
+            {
+                int best = queue[front];
+                p[t] = label(best) + D[t] + distances(m_dna[t - 1], 0);
+                pred[t] = best;
+
+                if (t == n)
+                    break;
+
+                double labelT = label(t);
+                bool dominated = Q[queue[back]] == Q[t] && label(queue[back]) <= labelT;
+
+                if (!dominated)
+                {
+                    while (back >= front && labelT <= label(queue[back]))
+                        --back;
+                    queue[++back] = static_cast<int>(t);
+                }
+
+                while (front <= back && Q[t + 1] - Q[queue[front]] > capacity)
+                    ++front;
+
+                if (front > back)
+                    return false;
+            }
+
+            buildRoutes(pred, p, Q, n);
+            return true;
         }
 
-        inline void Split(const std::vector<Node>& nodes, int capacity)
+        /**
+         * @brief Reference Split using the quadratic Bellman recursion over the giant tour.
+         *
+         * @param nodes
+         * @param distances
+         * @param capacity
+         *
+         * @return false if a single customer exceeds the capacity.
+         */
+        inline bool SplitBellman(const std::vector<Node>& nodes, const DistanceMatrix& distances, int capacity)
         {
             size_t n = m_dna.size();
-            std::vector<double> cost(n + 1, std::numeric_limits<double>::max());
-            std::vector<int> pred(n + 1, -1);
+            SplitLabels& buf = splitBuffers();
+            buf.reserve(n);
+
+            double* cost = buf.potential.data();
+            double* Q = buf.sumLoad.data();
+            int* pred = buf.pred.data();
+            std::fill(cost, cost + n + 1, std::numeric_limits<double>::max());
+            std::fill(pred, pred + n + 1, -1);
             cost[0] = 0;
 
+            Q[0] = 0;
+            for (size_t t = 1; t <= n; ++t)
+                Q[t] = Q[t - 1] + nodes[m_dna[t - 1]].getDemand();
+
             for (size_t i = 0; i < n; ++i)
             {
                 int load = 0;
@@ -101,13 +479,13 @@ namespace GA
                         break;
 
                     if (j == i)
-                        dist = utils::Distance(nodes[0], nodes[customer]) + utils::Distance(nodes[customer], nodes[0]);
+                        dist = distances(0, customer) + distances(customer, 0);
                     else
                     {
                         int prevCustomer = m_dna[j - 1];
-                        dist += utils::Distance(nodes[prevCustomer], nodes[customer]) 
-                                + utils::Distance(nodes[customer], nodes[0])
-                                - utils::Distance(nodes[prevCustomer], nodes[0]);
+                        dist += distances(prevCustomer, customer)
+                                + distances(customer, 0)
+                                - distances(prevCustomer, 0);
 
                     }
 
@@ -121,13 +499,36 @@ namespace GA
                 }
             }
 
-            m_routes.clear();
+            if (n > 0 && pred[n] < 0)
+                return false;
+
+            buildRoutes(pred, cost, Q, n);
+            return true;
+        }
+
+        /**
+         * @brief Rebuilds m_routes from the Split predecessors.
+         *
+         * @param pred Predecessor of each position in the giant tour.
+         * @param cost Cost of the best split of each prefix of the giant tour.
+         * @param load Prefix sums of the demands along the giant tour.
+         * @param n Number of customers.
+         */
+        inline void buildRoutes(const int* pred, const double* cost, const double* load, size_t n)
+        {
+            size_t count = 0;
+            for (int i = static_cast<int>(n); i > 0; i = pred[i])
+                ++count;
+
+            m_routes.resize(count);
+
+            size_t r = count;
             for (int i = static_cast<int>(n); i > 0; i = pred[i])
             {
                 int start = pred[i];
-                m_routes.emplace_back(m_dna.begin() + start, m_dna.begin() + i);
+                m_routes[--r] = Route{ static_cast<uint32_t>(start), static_cast<uint32_t>(i),
+                                       load[i] - load[start], cost[i] - cost[start] };
             }
-            std::reverse(m_routes.begin(), m_routes.end());
         }
     };
 }
@@ -0,0 +1,50 @@
+#ifndef CHROMOSOME_POOL_H
+#define CHROMOSOME_POOL_H
+#include "chromosome.hpp"
+
+namespace GA
+{
+    /**
+     * @brief Pool of chromosomes recycled between generations.
+     *
+     * The pool only grows: shrinking it keeps the chromosomes (and their DNA and route
+     * buffers) alive past the used range, so the next generation overwrites them in place
+     * instead of allocating new ones.
+     */
+    class ChromosomePool
+    {
+    public:
+        ChromosomePool() : m_items(), m_used(0) {}
+
+        /**
+         * @brief Sets the number of chromosomes in use, growing the pool if needed.
+         *
+         * @param count Number of chromosomes in use.
+         */
+        inline void resize(size_t count)
+        {
+            if (count > this->m_items.size())
+                this->m_items.resize(count);
+            this->m_used = count;
+        }
+
+        inline void clear() { this->m_used = 0; }
+
+        size_t size() const { return this->m_used; }
+        bool empty() const { return this->m_used == 0; }
+
+        Chromosome& operator[](size_t i) { return this->m_items[i]; }
+        const Chromosome& operator[](size_t i) const { return this->m_items[i]; }
+
+        Chromosome* begin() { return this->m_items.data(); }
+        Chromosome* end() { return this->m_items.data() + this->m_used; }
+        const Chromosome* begin() const { return this->m_items.data(); }
+        const Chromosome* end() const { return this->m_items.data() + this->m_used; }
+
+    private:
+        std::vector<Chromosome> m_items;
+        size_t m_used;
+    };
+}
+
+#endif
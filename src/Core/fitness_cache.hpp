@@ -0,0 +1,171 @@
+#ifndef FITNESS_CACHE_H
+#define FITNESS_CACHE_H
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "chromosome.hpp"
+
+namespace GA
+{
+    /**
+     * @brief Bounded cache of evaluated giant tours, keyed by DNA hash.
+     *
+     * Keeps the fitness and the routes found by Split for recently evaluated DNA, so a giant
+     * tour produced again does not go through Split. The table is direct-mapped: a new entry
+     * replaces the one in its slot, so the memory stays bounded. The routes of every entry are
+     * preallocated in one arena, so storing an evaluation never allocates; evaluations with
+     * more routes than an entry holds are not stored. Slots are split in shards with
+     * one lock each, so threads only contend when they touch the same shard.
+     *
+     * Entries are identified by the 64-bit DNA hash only.
+     */
+    class FitnessCache
+    {
+    public:
+        FitnessCache() : m_mask(0), m_shardMask(0), m_maxRoutes(0) {}
+
+        /**
+         * @brief Empties the cache and sets its size.
+         *
+         * @param entries Number of entries, rounded up to a power of two and lowered so the arena
+         * holds at most MAX_ROUTES routes; 0 disables the cache.
+         * @param maxRoutes Routes kept per entry.
+         */
+        inline void reset(size_t entries, size_t maxRoutes)
+        {
+            this->m_entries.clear();
+            this->m_routes.clear();
+            this->m_shards.reset();
+            this->m_mask = 0;
+            this->m_maxRoutes = maxRoutes;
+
+            if (entries == 0 || maxRoutes == 0)
+                return;
+
+            size_t size = 1;
+            while (size < entries)
+                size <<= 1;
+
+            // Instances with many routes get fewer entries, so the arena stays bounded.
+            while (size > 1 && size * maxRoutes > MAX_ROUTES)
+                size >>= 1;
+
+            size_t shards = std::min<size_t>(size, SHARDS);
+
+            this->m_entries.resize(size);
+            this->m_routes.resize(size * maxRoutes);
+            this->m_shards.reset(new Shard[shards]);
+            this->m_mask = size - 1;
+            this->m_shardMask = shards - 1;
+        }
+
+        bool enabled() const { return !this->m_entries.empty(); }
+
+        /**
+         * @brief Gives a chromosome the cached evaluation of its DNA, if there is one.
+         *
+         * @return true on a hit.
+         */
+        inline bool Lookup(Chromosome &chromosome)
+        {
+            if (!enabled())
+                return false;
+
+            uint64_t hash = chromosome.getHash();
+            size_t slot = hash & this->m_mask;
+            Shard &shard = this->m_shards[slot & this->m_shardMask];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            const Entry &entry = this->m_entries[slot];
+            if (!entry.used || entry.hash != hash)
+            {
+                shard.misses++;
+                return false;
+            }
+
+            chromosome.setEvaluation(entry.fitness, &this->m_routes[slot * this->m_maxRoutes], entry.routes);
+            shard.hits++;
+            return true;
+        }
+
+        /**
+         * @brief Stores the evaluation of an evaluated chromosome.
+         */
+        inline void Store(const Chromosome &chromosome)
+        {
+            const std::vector<Route> &routes = chromosome.getRoutes();
+            if (!enabled() || routes.size() > this->m_maxRoutes)
+                return;
+
+            uint64_t hash = chromosome.getHash();
+            size_t slot = hash & this->m_mask;
+            Shard &shard = this->m_shards[slot & this->m_shardMask];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            Entry &entry = this->m_entries[slot];
+            entry.used = true;
+            entry.hash = hash;
+            entry.fitness = chromosome.getFitness();
+            entry.routes = routes.size();
+            std::copy(routes.begin(), routes.end(), this->m_routes.begin() + slot * this->m_maxRoutes);
+        }
+
+        /**
+         * @brief Evaluates a chromosome through the cache.
+         *
+         * @return true if the evaluation came from the cache.
+         */
+        inline bool Evaluate(Chromosome &chromosome, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                             int capacity)
+        {
+            if (Lookup(chromosome))
+                return true;
+
+            chromosome.CalculateFitness(nodes, distances, capacity);
+            Store(chromosome);
+            return false;
+        }
+
+        unsigned long long getHits() const { return sum(&Shard::hits); }
+        unsigned long long getMisses() const { return sum(&Shard::misses); }
+
+    private:
+        static constexpr size_t SHARDS = 64;
+        static constexpr size_t MAX_ROUTES = size_t(1) << 20;   // Routes in the arena at most: 24 MB.
+
+        struct Entry
+        {
+            bool used = false;
+            uint64_t hash = 0;
+            double fitness = 0;
+            size_t routes = 0;      // Routes in the arena slice of the entry.
+        };
+
+        struct alignas(64) Shard
+        {
+            std::mutex mutex;
+            unsigned long long hits = 0;
+            unsigned long long misses = 0;
+        };
+
+        std::vector<Entry> m_entries;
+        std::vector<Route> m_routes;    // maxRoutes routes per entry.
+        std::unique_ptr<Shard[]> m_shards;
+        size_t m_mask;
+        size_t m_shardMask;
+        size_t m_maxRoutes;
+
+        inline unsigned long long sum(unsigned long long Shard::*counter) const
+        {
+            unsigned long long total = 0;
+            if (enabled())
+                for (size_t s = 0; s <= this->m_shardMask; ++s)
+                    total += this->m_shards[s].*counter;
+            return total;
+        }
+    };
+}
+
+#endif
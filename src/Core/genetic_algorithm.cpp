@@ -3,20 +3,50 @@
 #include "../Operators/crossover_mutation.hpp"
 #include "../Generate/kmeans.hpp"
 #include "../Generate/nearest_neighbor.hpp"
+#include "../Generate/savings.hpp"
+#include "../Generate/sweep.hpp"
+#include "alloc_counter.hpp"
 #include <unordered_set>
 #include <chrono>
+#include <cmath>
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace GA
 {
     GeneticAlgorithm::GeneticAlgorithm() {};
 
-    Population GeneticAlgorithm::Run()
+    const Population& GeneticAlgorithm::Run()
     {
         auto startTime = std::chrono::high_resolution_clock::now();
+        unsigned long long startAllocations = utils::AllocationCount();
 
         Initialize();
         this->m_population.Evaluation();
+        // Split joins two consecutive routes whenever their loads fit together, since that never
+        // costs more, so it rarely gives more than twice the vehicles needed by the demand.
+        this->m_fitnessCache.reset(this->m_param->fitness_cache, 2 * static_cast<size_t>(getVehicleCount()) + 2);
+        StartPool();
+
+        if (!RunTrajectorySearch(startTime))
+        {
+            if (this->m_param->steady_state)
+                RunSteadyState(startTime);
+            else
+                RunGenerational(startTime);
+        }
+
+        this->m_pool.Stop();
+        this->m_allocations = utils::AllocationCount() - startAllocations;
+
+        return this->m_population;
+    }
 
+    void GeneticAlgorithm::RunGenerational(std::chrono::high_resolution_clock::time_point startTime)
+    {
         for (int i = 0; i < this->m_param->generation; ++i)
         {
             auto currTime = std::chrono::high_resolution_clock::now();
@@ -25,10 +55,17 @@ namespace GA
             if (elapsedTime.count() > this->getParameters()->time_limit)
                 break;
 
+            unsigned long long generationAllocations = utils::AllocationCount();
+
             this->m_population.setGeneration(i + 1);
             Evolve();
             this->m_population.Evaluation();
 
+            this->m_last_generation_allocations = utils::AllocationCount() - generationAllocations;
+
+            if (this->m_generationCallback)
+                this->m_generationCallback(this->m_population);
+
             if (this->m_population.getBestFitness() < this->m_population.getLastBestFitness())
                 this->m_generations_no_improvements = 0;
             else
@@ -37,51 +74,149 @@ namespace GA
             if (this->m_generations_no_improvements >= this->m_param->stagnation_limit)
                 break;
         }
+    }
 
-        return this->m_population;
+    void GeneticAlgorithm::StartPool()
+    {
+        int threads = this->m_threads > 0 ? this->m_threads : this->m_param->threads;
+
+        if (threads <= 0)
+        {
+#ifdef _OPENMP
+            threads = omp_get_max_threads();
+#else
+            threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+#endif
+        }
+
+        this->m_pool.Start(threads, utils::GetThreadSeed());
+    }
+
+    int GeneticAlgorithm::getVehicleCount() const
+    {
+        if (this->m_param->capacity <= 0)
+            return 0;
+
+        double demand = 0;
+        for (const Node& node : this->m_nodes)
+            demand += node.getDemand();
+
+        return static_cast<int>(std::ceil(demand / this->m_param->capacity));
+    }
+
+    int GeneticAlgorithm::getClusterCount() const
+    {
+        int customers = static_cast<int>(this->m_nodes.size()) - 1;
+        if (this->m_param->capacity <= 0)
+            return std::max(1, std::min(MIN_CLUSTERS, customers));
+
+        double vehicles = getVehicleCount();
+        int clusters = std::max(MIN_CLUSTERS, static_cast<int>(std::ceil(vehicles / VEHICLES_PER_CLUSTER)));
+        return std::max(1, std::min(clusters, customers));
     }
 
     void GeneticAlgorithm::Initialize()
     {
         Population population;
         population.setNodes(this->getNodes());
+        population.setDistances(this->m_distances);
         population.setSize(this->m_param->population);
         population.setCapacity(this->m_param->capacity);
 
         std::vector<Chromosome> individuals;
 
-        for (int i = 0; i < this->m_param->population/2; ++i)
+        // The population is shared among the constructors in proportion to their weights; the
+        // rounding leftovers go to the constructors in order.
+        const int weights[] = { this->m_param->seeding_kmeans, this->m_param->seeding_savings,
+                                this->m_param->seeding_sweep, this->m_param->seeding_random };
+        int counts[4];
+        int totalWeight = std::max(1, weights[0] + weights[1] + weights[2] + weights[3]);
+        int remaining = this->m_param->population;
+
+        for (int t = 0; t < 4; ++t)
         {
+            counts[t] = this->m_param->population * weights[t] / totalWeight;
+            remaining -= counts[t];
+        }
+        for (int t = 0; remaining > 0; t = (t + 1) % 4)
+            if (weights[t] > 0 || totalWeight == 1)
+            {
+                counts[t]++;
+                remaining--;
+            }
+
+        auto add = [&individuals](const std::vector<gene_t>& dna) {
             Chromosome chromosome;
+            chromosome.setDNA(dna);
+            chromosome.setFitness(-1.0);
+            individuals.push_back(chromosome);
+        };
 
-            GEN::KMeans kmeans(4, this->m_nodes, this->m_param->max_x, this->m_param->max_y);
-            kmeans.run();
-            GEN::NearestNeighbor NN(kmeans.getClusters());
-            NN.run();
+        // K-means: a few clusterings of the customers, with several vehicle loads per cluster. The
+        // individuals built on the same clustering differ by the order, start and direction of
+        // the cluster tours.
+        if (counts[0] > 0)
+        {
+            int clusterCount = getClusterCount();
+            std::vector<std::vector<GEN::Cluster>> clusterings;
 
-            chromosome.setDNA(NN.getDna());
-            chromosome.setFitness(-1.0);
+            for (int i = 0; i < std::min(counts[0], CLUSTERINGS); ++i)
+            {
+                GEN::KMeans kmeans(clusterCount, this->m_nodes, this->m_param->max_x, this->m_param->max_y);
+                kmeans.run();
+                clusterings.push_back(kmeans.getClusters());
+            }
 
-            individuals.push_back(chromosome);
+            for (int i = 0; i < counts[0]; ++i)
+            {
+                GEN::NearestNeighbor NN(clusterings[i % clusterings.size()], this->m_nodes[0]);
+                NN.run();
+                add(NN.getDna());
+            }
         }
 
-        for (int i = 0; i < this->m_param->population/2; ++i)
+        // Savings: merges restricted to the neighbor lists of the local search, or to lists of
+        // NEIGHBORS customers when the local search has none. Those are built from the distance
+        // matrix, which EXPLICIT instances without coordinates have too.
+        if (counts[1] > 0)
         {
-            Chromosome chromosome;
+            NeighborLists ownNeighbors;
+            const NeighborLists* neighbors = &ownNeighbors;
 
-            std::vector<int> dna(this->m_param->dimension - 1);
-            std::iota(dna.begin(), dna.end(), 1);
-            std::shuffle(dna.begin(), dna.end(), std::mt19937{std::random_device{}()});
+            if (this->hasNeighbors() && this->getNeighbors().k() > 0)
+                neighbors = &this->getNeighbors();
+            else
+                ownNeighbors.Build(*this->m_distances, NEIGHBORS);
 
-            chromosome.setDNA(dna);
-            chromosome.setFitness(-1.0);
+            GEN::Savings savings(this->m_nodes, *this->m_distances, *neighbors, this->m_param->capacity);
+            for (int i = 0; i < counts[1]; ++i)
+            {
+                savings.run();
+                add(savings.getDna());
+            }
+        }
 
-            individuals.push_back(chromosome);
+        if (counts[2] > 0)
+        {
+            GEN::Sweep sweep(this->m_nodes);
+            for (int i = 0; i < counts[2]; ++i)
+            {
+                sweep.run();
+                add(sweep.getDna());
+            }
+        }
+
+        for (int i = 0; i < counts[3]; ++i)
+        {
+            std::vector<gene_t> dna(this->m_param->dimension - 1);
+            std::iota(dna.begin(), dna.end(), 1);
+            std::shuffle(dna.begin(), dna.end(), utils::Rng());
+            add(dna);
         }
 
         population.setIndividuals(individuals);
         population.setGeneration(1);
-        this->m_population = population;
+        this->m_population = std::move(population);
         this->m_generations_no_improvements = 0;
         this->m_population.setBestFitness(std::numeric_limits<double>::max());
         this->m_population.setLastBestFitness(std::numeric_limits<double>::max());
@@ -89,11 +224,182 @@ namespace GA
 
     void GeneticAlgorithm::Evolve()
     {
-        std::vector<Chromosome> parents = OP::TournamentSelection(this->m_population, this->m_param->parent_size);
-        std::vector<Chromosome> children = OP::CrossoverMutation(parents, this->m_population);
+        OP::TournamentSelection(this->m_population, this->m_param->parent_size,
+                                this->m_param->tournament_size, this->m_parents);
 
-        ApplyLocalSeach(children);
+        size_t pairs = this->m_parents.size() / 2;
+        this->m_children.resize(this->m_parents.size());
+        this->m_kept.assign(this->m_parents.size(), 0);
+        this->m_localSearch.assign(this->m_parents.size(), 0);
+        this->m_costs.resize(pairs);
+
+        // The children going through local search are drawn beforehand, so each task has a cost
+        // estimate: linear for crossover, mutation and evaluation, plus routes x n per local
+        // search, taking the routes of the parent the child inherits its cut from.
+        const std::vector<Chromosome>& individuals = this->m_population.getIndividuals();
+        double lsRate = getLocalSearchRate();
+        double n = static_cast<double>(this->m_nodes.size());
+
+        for (size_t pair = 0; pair < pairs; ++pair)
+        {
+            this->m_costs[pair] = n;
 
-        this->m_population.SurviveSelection(children);
+            for (size_t i = 2 * pair; i < 2 * pair + 2; ++i)
+            {
+                if (lsRate <= 0 || utils::randDouble(0, 1) >= lsRate)
+                    continue;
+
+                this->m_localSearch[i] = 1;
+                this->m_costs[pair] += individuals[this->m_parents[i]].getRoutes().size() * n;
+            }
+        }
+
+        // Every task reseeds the generator of its thread from this key, so the children do not
+        // depend on which thread ran them. The generator of this thread is restored afterwards.
+        utils::Xoshiro256 generator = utils::Rng();
+        this->m_generationKey = generator();
+
+        auto breed = [this](size_t pair) { Breed(pair); };
+        this->m_pool.ParallelFor(pairs, breed, &this->m_costs);
+
+        utils::Rng() = generator;
+
+        // Drop discarded children, keeping their buffers in the pool.
+        size_t kept = 0;
+        for (size_t i = 0; i < this->m_children.size(); ++i)
+        {
+            if (!this->m_kept[i])
+                continue;
+
+            if (kept != i)
+                std::swap(this->m_children[kept], this->m_children[i]);
+            kept++;
+        }
+        this->m_children.resize(kept);
+
+        this->m_population.SurviveSelection(this->m_children);
+    }
+
+    void GeneticAlgorithm::RunSteadyState(std::chrono::high_resolution_clock::time_point startTime)
+    {
+        this->m_population.setGeneration(1);
+        this->m_population.setLastBestFitness(this->m_population.getBestFitness());
+        this->m_produced = 0;
+        this->m_generationAllocations = utils::AllocationCount();
+        this->m_stop.store(false, std::memory_order_relaxed);
+
+        // Each worker gets a generator of its own; with a single thread the run is reproducible.
+        utils::Xoshiro256 generator = utils::Rng();
+        this->m_generationKey = generator();
+
+        auto worker = [this, startTime](size_t w) { SteadyStateWorker(w, startTime); };
+        this->m_pool.ParallelFor(this->m_pool.size(), worker);
+
+        utils::Rng() = generator;
+    }
+
+    void GeneticAlgorithm::SteadyStateWorker(size_t worker, std::chrono::high_resolution_clock::time_point startTime)
+    {
+        utils::Rng().Seed(this->m_generationKey + worker * 0xd1b54a32d192ed03ULL);
+
+        thread_local std::vector<int> parents;
+        thread_local Chromosome children[2];
+        char kept[2];
+
+        // Children produced per generation, as in the generational mode.
+        long long generationSize = std::max(2, this->m_param->parent_size - this->m_param->parent_size % 2);
+        double lsRate = getLocalSearchRate();
+
+        while (!this->m_stop.load(std::memory_order_relaxed))
+        {
+            {
+                std::shared_lock<std::shared_mutex> lock(this->m_populationMutex);
+
+                OP::TournamentSelection(this->m_population, 2, this->m_param->tournament_size, parents);
+                if (parents.size() < 2)
+                {
+                    this->m_stop.store(true, std::memory_order_relaxed);
+                    break;
+                }
+
+                const std::vector<Chromosome>& individuals = this->m_population.getIndividuals();
+                OP::CrossoverMutation(individuals[parents[0]], individuals[parents[1]], this->m_population,
+                                      children[0], children[1], kept);
+            }
+
+            // Evaluation and local search, the expensive part, run without any lock.
+            for (int k = 0; k < 2; ++k)
+            {
+                if (!kept[k])
+                    continue;
+
+                this->m_fitnessCache.Evaluate(children[k], this->m_nodes, *this->m_distances, this->m_param->capacity);
+
+                if (lsRate > 0 && utils::randDouble(0, 1) < lsRate)
+                    ApplyLocalSeach(children[k]);
+            }
+
+            std::unique_lock<std::shared_mutex> lock(this->m_populationMutex);
+
+            // A child takes the place of the worst individual if it is better and not a duplicate.
+            for (int k = 0; k < 2; ++k)
+                if (kept[k])
+                    this->m_population.Immigrate(children[k]);
+
+            long long before = this->m_produced;
+            this->m_produced += 2;
+
+            if (this->m_produced / generationSize != before / generationSize)
+                EndSteadyStateGeneration(startTime);
+        }
+    }
+
+    void GeneticAlgorithm::EndSteadyStateGeneration(std::chrono::high_resolution_clock::time_point startTime)
+    {
+        unsigned long long allocations = utils::AllocationCount();
+        this->m_last_generation_allocations = allocations - this->m_generationAllocations;
+        this->m_generationAllocations = allocations;
+
+        this->m_population.setGeneration(this->m_population.getGeneration() + 1);
+
+        if (this->m_generationCallback)
+            this->m_generationCallback(this->m_population);
+
+        if (this->m_population.getBestFitness() < this->m_population.getLastBestFitness())
+            this->m_generations_no_improvements = 0;
+        else
+            this->m_generations_no_improvements++;
+
+        this->m_population.setLastBestFitness(this->m_population.getBestFitness());
+
+        std::chrono::duration<double> elapsedTime = std::chrono::high_resolution_clock::now() - startTime;
+
+        if (this->m_generations_no_improvements >= this->m_param->stagnation_limit ||
+            this->m_population.getGeneration() > this->m_param->generation ||
+            elapsedTime.count() > this->m_param->time_limit)
+            this->m_stop.store(true, std::memory_order_relaxed);
+    }
+
+    void GeneticAlgorithm::Breed(size_t pair)
+    {
+        utils::Rng().Seed(this->m_generationKey + pair * 0xd1b54a32d192ed03ULL);
+
+        const std::vector<Chromosome>& individuals = this->m_population.getIndividuals();
+        size_t first = 2 * pair;
+
+        OP::CrossoverMutation(individuals[this->m_parents[first]], individuals[this->m_parents[first + 1]],
+                              this->m_population, this->m_children[first], this->m_children[first + 1],
+                              &this->m_kept[first]);
+
+        for (size_t i = first; i < first + 2; ++i)
+        {
+            if (!this->m_kept[i])
+                continue;
+
+            this->m_fitnessCache.Evaluate(this->m_children[i], this->m_nodes, *this->m_distances, this->m_param->capacity);
+
+            if (this->m_localSearch[i])
+                ApplyLocalSeach(this->m_children[i]);
+        }
     }
 }
\ No newline at end of file
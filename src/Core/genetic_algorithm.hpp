@@ -1,9 +1,17 @@
 #ifndef GENETIC_ALGORITHM_H
 #define GENETIC_ALGORITHM_H
 #include "population.hpp"
+#include "neighbor_lists.hpp"
+#include "chromosome_pool.hpp"
+#include "task_pool.hpp"
+#include "fitness_cache.hpp"
 #include <random>
 #include <unordered_map>
 #include <fstream>
+#include <functional>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
 
 namespace GA
 {
@@ -18,6 +26,7 @@ namespace GA
     {
     public:
         GeneticAlgorithm();
+        virtual ~GeneticAlgorithm() = default;
 
         /**
          * @brief Runs the genetic algorithm.
@@ -28,41 +37,182 @@ namespace GA
          *
          * @return The final population after running the algorithm.
          */
-        Population Run();
+        const Population& Run();
 
         //GETTERS AND SETTERS
-        Population getPopulation() const { return this->m_population; }
+        const Population& getPopulation() const { return this->m_population; }
 
-        const std::vector<Node> getNodes() const { return this->m_nodes; }
+        /**
+         * @brief Sets a function called with the population at the end of every generation.
+         *
+         * Used by the island model to exchange migrants between populations.
+         */
+        void setGenerationCallback(std::function<void(Population&)> callback) { this->m_generationCallback = std::move(callback); }
+
+        /**
+         * @brief Pool that ran the children of the generations, with its per-thread statistics.
+         */
+        const TaskPool& getPool() const { return this->m_pool; }
+
+        /**
+         * @brief Cache of the evaluations of the children, with its hit and miss counts.
+         */
+        const FitnessCache& getFitnessCache() const { return this->m_fitnessCache; }
+
+        unsigned long long getAllocations() const { return this->m_allocations; }
+        unsigned long long getLastGenerationAllocations() const { return this->m_last_generation_allocations; }
+
+        const std::vector<Node>& getNodes() const { return this->m_nodes; }
         void setNodes(std::vector<Node>& nodes) { this->m_nodes = nodes; }
 
+        const DistanceMatrix& getDistances() const { return *this->m_distances; }
+        void setDistances(const DistanceMatrix* distances) { this->m_distances = distances; }
+
+        const NeighborLists& getNeighbors() const { return *this->m_neighbors; }
+        bool hasNeighbors() const { return this->m_neighbors != nullptr; }
+        void setNeighbors(const NeighborLists* neighbors) { this->m_neighbors = neighbors; }
+
         const Parameters* getParameters() const { return this->m_param; }
         void setParameters(Parameters* param) { this->m_param = param; }
 
+        /**
+         * @brief Sets the number of threads of the task pool; 0 (default) takes it from the parameters.
+         *
+         * Used to run islands and batch repetitions on a single thread each.
+         */
+        void setThreads(int threads) { this->m_threads = threads; }
+
     private:
         Population m_population;
         std::vector<Node> m_nodes;
+        const DistanceMatrix* m_distances = nullptr;
+        const NeighborLists* m_neighbors = nullptr;
         Parameters* m_param;
+        int m_threads = 0;
 
         int m_generations_no_improvements;
 
+        // Buffers recycled between generations.
+        std::vector<int> m_parents;
+        ChromosomePool m_children;
+        std::vector<char> m_kept;
+        std::vector<char> m_localSearch;
+        std::vector<double> m_costs;
+
+        TaskPool m_pool;
+        FitnessCache m_fitnessCache;
+        uint64_t m_generationKey = 0;
+
+        // State of the steady-state mode, shared by its workers.
+        std::shared_mutex m_populationMutex;
+        std::atomic<bool> m_stop{false};
+        long long m_produced = 0;
+        unsigned long long m_generationAllocations = 0;
+
+        std::function<void(Population&)> m_generationCallback;
+
+        unsigned long long m_allocations = 0;
+        unsigned long long m_last_generation_allocations = 0;
+
+        // Number of K-means clusterings shared by the seeded individuals.
+        static constexpr int CLUSTERINGS = 4;
+
+        // Vehicle loads per cluster of the seeding. Clusters of a single load make poor giant
+        // tours: Split has no slack to balance the routes across cluster boundaries.
+        static constexpr double VEHICLES_PER_CLUSTER = 16;
+
+        // Fewest clusters of the seeding, so small fleets still get distinct clusterings.
+        static constexpr int MIN_CLUSTERS = 4;
+
         /**
-         * @brief Initialize the genetic algorithm.
+         * @brief Vehicles needed by the total demand, or 0 without a capacity.
          */
-        void Initialize();
+        int getVehicleCount() const;
+
+        /**
+         * @brief Number of clusters for the seeding, from the vehicles needed by the total demand,
+         * never below MIN_CLUSTERS.
+         */
+        int getClusterCount() const;
 
         /**
          * @brief Process the evolution of GA.
+         *
+         * Each pair of parents is one task of the pool, which runs crossover, mutation,
+         * evaluation and local search of its two children.
          */
         void Evolve();
 
+        /**
+         * @brief Runs the generational mode until a stop criterion is met.
+         */
+        void RunGenerational(std::chrono::high_resolution_clock::time_point startTime);
+
+        /**
+         * @brief Runs the asynchronous steady-state mode until a stop criterion is met.
+         *
+         * Every thread of the pool repeatedly selects two parents, produces their children and
+         * inserts each one in place of the worst individual, without waiting for the others.
+         * Selection and crossover hold a shared lock on the population and insertion an
+         * exclusive one; evaluation and local search hold none. A generation is counted every
+         * parent_size children, for the stop criteria and the generation callback.
+         */
+        void RunSteadyState(std::chrono::high_resolution_clock::time_point startTime);
+
+        /**
+         * @brief Loop of one steady-state worker.
+         */
+        void SteadyStateWorker(size_t worker, std::chrono::high_resolution_clock::time_point startTime);
+
+        /**
+         * @brief Closes a steady-state generation and checks the stop criteria. Runs under the exclusive lock.
+         */
+        void EndSteadyStateGeneration(std::chrono::high_resolution_clock::time_point startTime);
+
+        /**
+         * @brief Produces the two children of a pair of selected parents.
+         *
+         * @param pair Index of the pair in the selected parents.
+         */
+        void Breed(size_t pair);
+
     protected:
+        /**
+         * @brief Initialize the genetic algorithm.
+         */
+        void Initialize();
+
+        /**
+         * @brief Starts the task pool with the thread count set by setThreads, or else by
+         * --threads, or else half the processors (the OpenMP thread count in OpenMP builds).
+         */
+        void StartPool();
+
+        TaskPool& getTaskPool() { return this->m_pool; }
+        Population& getMutablePopulation() { return this->m_population; }
+
         /**
          * @brief Apply local search in GA to become an MA
-         * 
-         * @param children children to apply local search
+         *
+         * Called from the tasks of the pool, so it may run on several children at once.
+         *
+         * @param child evaluated child to apply local search
+         */
+        virtual void ApplyLocalSeach(Chromosome&) {};
+
+        /**
+         * @brief Probability of a child to go through the local search.
+         */
+        virtual double getLocalSearchRate() const { return 0.0; }
+
+        /**
+         * @brief Lets a subclass replace the evolution by a search from the initial population.
+         *
+         * Called once the population is initialized and the pool started.
+         *
+         * @return true if the search ran, false to evolve the population.
          */
-        virtual void ApplyLocalSeach(std::vector<Chromosome>&) {};
+        virtual bool RunTrajectorySearch(std::chrono::high_resolution_clock::time_point) { return false; }
     };
 }
 
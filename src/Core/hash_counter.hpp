@@ -0,0 +1,130 @@
+#ifndef HASH_COUNTER_H
+#define HASH_COUNTER_H
+#include <cstdint>
+#include <vector>
+
+namespace GA
+{
+    /**
+     * @brief Open-addressing multiset of 64-bit hashes.
+     *
+     * Counts how many times each hash was inserted. Uses linear probing with backward-shift
+     * deletion over a power-of-two table, so insertions and removals never allocate once the
+     * table has grown to fit the population.
+     */
+    class HashCounter
+    {
+    public:
+        HashCounter() : m_keys(), m_counts(), m_mask(0), m_size(0) {}
+
+        /**
+         * @brief Removes every hash and makes room for at least `expected` distinct ones.
+         *
+         * @param expected Expected number of distinct hashes.
+         */
+        inline void reset(size_t expected)
+        {
+            size_t capacity = 16;
+            while (capacity < 2 * expected)
+                capacity <<= 1;
+
+            this->m_keys.assign(capacity, EMPTY);
+            this->m_counts.assign(capacity, 0);
+            this->m_mask = capacity - 1;
+            this->m_size = 0;
+        }
+
+        inline void insert(uint64_t hash)
+        {
+            hash = key(hash);
+
+            if (2 * (this->m_size + 1) > this->m_keys.size())
+                grow();
+
+            size_t i = find(hash);
+            if (this->m_keys[i] == EMPTY)
+            {
+                this->m_keys[i] = hash;
+                this->m_size++;
+            }
+            this->m_counts[i]++;
+        }
+
+        inline void erase(uint64_t hash)
+        {
+            if (this->m_keys.empty())
+                return;
+
+            hash = key(hash);
+            size_t i = find(hash);
+            if (this->m_keys[i] == EMPTY || --this->m_counts[i] > 0)
+                return;
+
+            // Backward-shift deletion: pull later entries of the probe chain into the hole.
+            size_t hole = i;
+            for (size_t j = (i + 1) & this->m_mask; this->m_keys[j] != EMPTY; j = (j + 1) & this->m_mask)
+            {
+                size_t home = this->m_keys[j] & this->m_mask;
+                if (((j - home) & this->m_mask) >= ((j - hole) & this->m_mask))
+                {
+                    this->m_keys[hole] = this->m_keys[j];
+                    this->m_counts[hole] = this->m_counts[j];
+                    hole = j;
+                }
+            }
+
+            this->m_keys[hole] = EMPTY;
+            this->m_counts[hole] = 0;
+            this->m_size--;
+        }
+
+        inline bool contains(uint64_t hash) const
+        {
+            if (this->m_keys.empty())
+                return false;
+
+            return this->m_keys[find(key(hash))] != EMPTY;
+        }
+
+    private:
+        static constexpr uint64_t EMPTY = 0;
+
+        std::vector<uint64_t> m_keys;
+        std::vector<int> m_counts;
+        size_t m_mask;
+        size_t m_size;
+
+        static inline uint64_t key(uint64_t hash) { return hash == EMPTY ? 1 : hash; }
+
+        inline size_t find(uint64_t hash) const
+        {
+            size_t i = hash & this->m_mask;
+            while (this->m_keys[i] != EMPTY && this->m_keys[i] != hash)
+                i = (i + 1) & this->m_mask;
+            return i;
+        }
+
+        inline void grow()
+        {
+            std::vector<uint64_t> keys;
+            std::vector<int> counts;
+            keys.swap(this->m_keys);
+            counts.swap(this->m_counts);
+
+            reset(keys.empty() ? 8 : keys.size());
+
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                if (keys[i] == EMPTY)
+                    continue;
+
+                size_t j = find(keys[i]);
+                this->m_keys[j] = keys[i];
+                this->m_counts[j] = counts[i];
+                this->m_size++;
+            }
+        }
+    };
+}
+
+#endif
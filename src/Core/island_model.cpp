@@ -0,0 +1,104 @@
+#include "island_model.hpp"
+#include "memetic_algorithm.hpp"
+#include <thread>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace GA
+{
+    void IslandModel::Run()
+    {
+        int islands = std::max(1, this->m_param->islands);
+
+        this->m_islands.clear();
+        this->m_inboxes.clear();
+
+        for (int i = 0; i < islands; ++i)
+        {
+            std::unique_ptr<GeneticAlgorithm> island;
+
+            if (this->m_param->algorithm == "GA")
+                island.reset(new GeneticAlgorithm());
+            else
+                island.reset(new MA::MemeticAlgorithm());
+
+            island->setNodes(this->m_nodes);
+            island->setDistances(this->m_distances);
+            island->setNeighbors(this->m_neighbors);
+            island->setParameters(this->m_param);
+            island->setThreads(1);
+            island->setGenerationCallback([this, i](Population& population) { Migrate(i, population); });
+
+            this->m_islands.push_back(std::move(island));
+
+            // Full topology receives from every other island at each migration.
+            this->m_inboxes.emplace_back(new MigrationQueue(4 * islands * std::max(1, this->m_param->migrants)));
+        }
+
+        std::vector<std::thread> threads;
+        uint64_t seed = utils::GetThreadSeed();
+
+        for (int i = 0; i < islands; ++i)
+        {
+            threads.emplace_back([this, i, seed]()
+            {
+                // Each island is one thread: its own random substream and no nested OpenMP team.
+                utils::SetThreadSeed(seed, i + 1);
+#ifdef _OPENMP
+                omp_set_num_threads(1);
+#endif
+                this->m_islands[i]->Run();
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        this->m_bestIsland = 0;
+        for (int i = 1; i < islands; ++i)
+            if (this->m_islands[i]->getPopulation().getBestFitness() <
+                this->m_islands[this->m_bestIsland]->getPopulation().getBestFitness())
+                this->m_bestIsland = i;
+    }
+
+    void IslandModel::Migrate(int island, Population& population)
+    {
+        int islands = static_cast<int>(this->m_islands.size());
+
+        thread_local Chromosome migrant;
+
+        while (this->m_inboxes[island]->TryPop(migrant))
+            population.Immigrate(migrant);
+
+        int interval = std::max(1, this->m_param->migration_interval);
+        if (islands < 2 || population.getGeneration() % interval != 0)
+            return;
+
+        thread_local std::vector<int> elites;
+        population.BestIndices(this->m_param->migrants, elites);
+
+        const std::vector<Chromosome>& individuals = population.getIndividuals();
+
+        auto send = [&](int destination)
+        {
+            for (int e : elites)
+                this->m_inboxes[destination]->TryPush(individuals[e]);
+        };
+
+        if (this->m_param->topology == "full")
+        {
+            for (int destination = 0; destination < islands; ++destination)
+                if (destination != island)
+                    send(destination);
+        }
+        else if (this->m_param->topology == "random")
+        {
+            int destination = utils::randInteger(0, islands - 2);
+            send(destination >= island ? destination + 1 : destination);
+        }
+        else
+            send((island + 1) % islands);
+    }
+}
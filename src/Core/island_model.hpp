@@ -0,0 +1,59 @@
+#ifndef ISLAND_MODEL_H
+#define ISLAND_MODEL_H
+#include "genetic_algorithm.hpp"
+#include "migration_queue.hpp"
+#include <memory>
+
+namespace GA
+{
+    /**
+     * @brief Island-model parallel genetic algorithm.
+     *
+     * Runs several independent GA (or MA) populations, each on its own thread. Every
+     * migration interval, an island sends copies of its best individuals to other islands
+     * through lock-free queues and takes in the migrants waiting in its own queue. The
+     * destinations follow the topology: the next island (ring), one random island (random)
+     * or every other island (full).
+     */
+    class IslandModel
+    {
+    public:
+        IslandModel() : m_param(nullptr), m_distances(nullptr), m_neighbors(nullptr), m_bestIsland(0) {}
+
+        /**
+         * @brief Runs every island until it stops and keeps the best one.
+         */
+        void Run();
+
+        // GETTERS AND SETTERS
+        const Population& getPopulation() const { return this->m_islands[this->m_bestIsland]->getPopulation(); }
+
+        int getBestIsland() const { return this->m_bestIsland; }
+        int getIslands() const { return static_cast<int>(this->m_islands.size()); }
+
+        void setNodes(std::vector<Node>& nodes) { this->m_nodes = nodes; }
+        void setDistances(const DistanceMatrix* distances) { this->m_distances = distances; }
+        void setNeighbors(const NeighborLists* neighbors) { this->m_neighbors = neighbors; }
+        void setParameters(Parameters* param) { this->m_param = param; }
+
+    private:
+        std::vector<Node> m_nodes;
+        Parameters* m_param;
+        const DistanceMatrix* m_distances;
+        const NeighborLists* m_neighbors;
+
+        std::vector<std::unique_ptr<GeneticAlgorithm>> m_islands;
+        std::vector<std::unique_ptr<MigrationQueue>> m_inboxes;
+        int m_bestIsland;
+
+        /**
+         * @brief Sends the best individuals of an island and takes in its migrants.
+         *
+         * @param island Index of the island.
+         * @param population Population of the island.
+         */
+        void Migrate(int island, Population& population);
+    };
+}
+
+#endif
@@ -1,166 +1,96 @@
 #include "memetic_algorithm.hpp"
+#include "../LocalSearch/local_search.hpp"
+#include "../LocalSearch/annealing.hpp"
+#include "../LocalSearch/parallel_tempering.hpp"
 
 namespace MA
 {
-    void MemeticAlgorithm::ApplyLocalSeach(std::vector<GA::Chromosome>& children)
+    void MemeticAlgorithm::ApplyLocalSeach(GA::Chromosome& child)
     {
-        double lsProb = 0.3;
-
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (size_t i = 0; i < children.size(); ++i)
-        {
-            double randProb = utils::randDouble(0, 1);
-
-            if (randProb < lsProb)
-                SimulatedAnnealing(children[i]);
-        }
+        // Infeasible children (a customer above the capacity) have no routes to improve.
+        if (child.getRoutes().empty())
+            return;
+
+        if (this->getParameters()->algorithm == "MA-LS")
+            HillClimbing(child);
+        else if (this->getParameters()->algorithm == "MA-PT")
+            ParallelTempering(child);
+        else
+            SimulatedAnnealing(child);
     }
 
-    void MemeticAlgorithm::SimulatedAnnealing(GA::Chromosome& child)
+    bool MemeticAlgorithm::RunTrajectorySearch(std::chrono::high_resolution_clock::time_point startTime)
+    {
+        if (this->getParameters()->algorithm != "PT")
+            return false;
+
+        const Parameters* param = this->getParameters();
+        GA::Population& population = this->getMutablePopulation();
+
+        std::vector<int> best;
+        population.BestIndices(1, best);
+        GA::Chromosome solution = population.getIndividuals()[best[0]];
+
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - startTime;
+
+        // Every round walks each replica once per customer.
+        LS::TemperingOptions options;
+        options.replicas = param->replicas;
+        options.rounds = param->generation;
+        options.steps = static_cast<int>(solution.getDNA().size());
+        options.stagnation = param->stagnation_limit;
+        options.timeLimit = param->time_limit - elapsed.count();
+
+        LS::ParallelTempering tempering;
+        int rounds = tempering.Run(solution, this->getNodes(), this->getDistances(), param->capacity, options,
+                                   &this->getTaskPool());
+
+        population.Immigrate(solution);
+        population.setGeneration(rounds);
+        return true;
+    }
+
+    void MemeticAlgorithm::ParallelTempering(GA::Chromosome& child)
     {
-        double temperature = 10;
-        double cooling = 0.95;
-        double absolute_min_temp = 0.1;
-
-        GA::Chromosome currentSolution = child;
-        GA::Chromosome bestSolution = child;
-
-        currentSolution.CalculateFitness(this->getNodes(), this->getParameters()->capacity);
-        bestSolution.CalculateFitness(this->getNodes(), this->getParameters()->capacity);
-
-        while (temperature > absolute_min_temp)
-        {
-            GA::Chromosome neighbor = GenerateNeighborSwapStar(currentSolution);
-            neighbor.CalculateFitness(this->getNodes(), this->getParameters()->capacity);
-
-            double currentFitness = currentSolution.getFitness();
-            double neighborFitness = neighbor.getFitness();
-
-            if (neighborFitness < currentFitness)
-            {
-                currentSolution = neighbor;
-                if (neighborFitness < bestSolution.getFitness())
-                    bestSolution = neighbor;
-            }
-            else
-            {
-                double deltaFitness = neighborFitness - currentFitness;
-                double acceptProbability = exp(-deltaFitness / temperature);
-                double randVal = utils::randDouble(0, 1);
-
-                if (randVal < acceptProbability)
-                    currentSolution = neighbor;
-            }
-
-            temperature *= cooling;
-        }
-        child = bestSolution;
+        thread_local LS::ParallelTempering tempering;
+
+        LS::TemperingOptions options;
+        options.replicas = this->getParameters()->replicas;
+
+        tempering.Run(child, this->getNodes(), this->getDistances(), this->getParameters()->capacity, options);
     }
 
-    GA::Chromosome MemeticAlgorithm::GenerateNeighborSwapStar(const GA::Chromosome& solution)
+    void MemeticAlgorithm::HillClimbing(GA::Chromosome& child)
     {
-        GA::Chromosome neighbor = solution;
-        std::vector<std::vector<int>> current_routes = neighbor.getRoutes();
+        thread_local LS::LocalSearch engine;
+        static const NeighborLists noNeighbors;
+
+        const NeighborLists& neighbors = this->hasNeighbors() ? this->getNeighbors() : noNeighbors;
+
+        if (engine.Run(child, this->getNodes(), this->getDistances(), neighbors, this->getParameters()->capacity) > 0)
+            child.CalculateFitness(this->getNodes(), this->getDistances(), this->getParameters()->capacity);
+    }
 
-        if (current_routes.size() < 2) {
-            return neighbor;
-        }
+    void MemeticAlgorithm::SimulatedAnnealing(GA::Chromosome& child)
+    {
+        thread_local LS::Annealing engine;
+        static const NeighborLists noNeighbors;
 
-        const auto& nodesRef = this->getNodes();
+        const NeighborLists& neighbors = this->hasNeighbors() ? this->getNeighbors() : noNeighbors;
         int capacity = this->getParameters()->capacity;
-        const double epsilon = 1e-9;
-
-        double best_deltaCost = epsilon;
-        bool found_improvement = false;
-        size_t best_r1_idx = -1, best_r2_idx = -1;
-        size_t best_i_pos = -1, best_j_pos = -1;
-
-        for (size_t r1_idx = 0; r1_idx < current_routes.size(); ++r1_idx)
-        {
-            int original_load1 = 0;
-            if (!current_routes[r1_idx].empty()) {
-                 for (int nodeIdx : current_routes[r1_idx]) original_load1 += nodesRef[nodeIdx].getDemand();
-            } else {
-                continue;
-            }
-
-
-            for (size_t r2_idx = r1_idx + 1; r2_idx < current_routes.size(); ++r2_idx)
-            {
-                const auto& route1_ref = current_routes[r1_idx];
-                const auto& route2_ref = current_routes[r2_idx];
-
-                int original_load2 = 0;
-                if (!route2_ref.empty()) {
-                    for (int nodeIdx : route2_ref) original_load2 += nodesRef[nodeIdx].getDemand();
-                } else {
-                     continue;
-                }
-
-
-                for (size_t i_pos = 0; i_pos < route1_ref.size(); ++i_pos)
-                {
-                    for (size_t j_pos = 0; j_pos < route2_ref.size(); ++j_pos)
-                    {
-                        int node_u = route1_ref[i_pos];
-                        int node_v = route2_ref[j_pos];
-
-                        int demand_u = nodesRef[node_u].getDemand();
-                        int demand_v = nodesRef[node_v].getDemand();
-
-                        int newLoad1 = original_load1 - demand_u + demand_v;
-                        int newLoad2 = original_load2 - demand_v + demand_u;
-
-                        if (newLoad1 > capacity || newLoad2 > capacity) {
-                            continue;
-                        }
-
-                        int prev_u = (i_pos == 0) ? 0 : route1_ref[i_pos - 1];
-                        int next_u = (i_pos == route1_ref.size() - 1) ? 0 : route1_ref[i_pos + 1];
-                        int prev_v = (j_pos == 0) ? 0 : route2_ref[j_pos - 1];
-                        int next_v = (j_pos == route2_ref.size() - 1) ? 0 : route2_ref[j_pos + 1];
-
-                        double removed_cost = utils::Distance(nodesRef[prev_u], nodesRef[node_u]) +
-                                              utils::Distance(nodesRef[node_u], nodesRef[next_u]) +
-                                              utils::Distance(nodesRef[prev_v], nodesRef[node_v]) +
-                                              utils::Distance(nodesRef[node_v], nodesRef[next_v]);
-
-                        double added_cost = utils::Distance(nodesRef[prev_u], nodesRef[node_v]) + 
-                                            utils::Distance(nodesRef[node_v], nodesRef[next_u]) +
-                                            utils::Distance(nodesRef[prev_v], nodesRef[node_u]) + 
-                                            utils::Distance(nodesRef[node_u], nodesRef[next_v]);
-
-                        double deltaCost = added_cost - removed_cost;
-
-                        if (deltaCost < best_deltaCost)
-                        {
-                            best_deltaCost = deltaCost;
-                            best_r1_idx = r1_idx;
-                            best_r2_idx = r2_idx;
-                            best_i_pos = i_pos;
-                            best_j_pos = j_pos;
-                            found_improvement = true;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (found_improvement)
-        {
-            std::vector<std::vector<int>> modifiedRoutes = current_routes;
-
-            int node_u_to_move = modifiedRoutes[best_r1_idx][best_i_pos];
-            int node_v_to_move = modifiedRoutes[best_r2_idx][best_j_pos];
-
-            modifiedRoutes[best_r1_idx][best_i_pos] = node_v_to_move;
-            modifiedRoutes[best_r2_idx][best_j_pos] = node_u_to_move;
-
-            neighbor.setRoutes(modifiedRoutes);
-        }
-
-        return neighbor;
+
+        // Same schedule as before: from 10 down to 0.1, cooling by 0.95, one move per temperature.
+        LS::AnnealingSchedule schedule;
+        schedule.temperature = 10;
+        schedule.cooling = 0.95;
+        schedule.minTemperature = 0.1;
+        schedule.steps = 1;
+
+        // The SWAP* steps the old loop made, one per temperature, descend from the annealed
+        // routes; they stop early at the first step that does not improve.
+        for (double temperature = schedule.temperature; temperature > schedule.minTemperature; temperature *= schedule.cooling)
+            schedule.swapStar++;
+
+        engine.Run(child, this->getNodes(), this->getDistances(), neighbors, capacity, schedule);
     }
 }
\ No newline at end of file
@@ -18,34 +18,51 @@ namespace MA
 
     private:
         /**
-         * @brief Applies a local search to a population of chromosomes.
+         * @brief Applies a local search to a child.
          *
-         * @param population A vector of chromosomes to which the local search will be applied.
+         * @param child The evaluated child to which the local search will be applied.
          */
-        void ApplyLocalSeach(std::vector<GA::Chromosome>&) override;
+        void ApplyLocalSeach(GA::Chromosome&) override;
+
+        /**
+         * @brief With the PT algorithm, runs parallel tempering from the best initial individual
+         * instead of evolving the population. The replicas run on the task pool.
+         */
+        bool RunTrajectorySearch(std::chrono::high_resolution_clock::time_point startTime) override;
+
+        /**
+         * @brief 30% of the children go through the local search.
+         */
+        double getLocalSearchRate() const override { return 0.3; }
 
         /**
          * @brief Performs hill climbing on a given chromosome.
          *
+         * Runs the LS::LocalSearch engine (relocate, swap, 2-opt, 2-opt* and or-opt) until no
+         * improving move is left.
+         *
          * @param chromosome The chromosome on which hill climbing will be applied.
          */
         void HillClimbing(GA::Chromosome&);
 
         /**
-         * @brief Applies simulated annealing to a given chromosome.
+         * @brief Applies parallel tempering to a given chromosome, running the replicas on the calling thread.
          *
-         * @param chromosome The chromosome on which simulated annealing will be applied.
+         * Uses the temperature range of SimulatedAnnealing, with 90 steps per replica.
+         *
+         * @param chromosome The chromosome on which parallel tempering will be applied.
          */
-        void SimulatedAnnealing(GA::Chromosome&);
+        void ParallelTempering(GA::Chromosome&);
 
         /**
-         * @brief Generates a SWAP* neighbor for a given chromosome.
+         * @brief Applies simulated annealing to a given chromosome.
          *
-         * @param chromosome The original chromosome for which a neighboring solution will be generated.
-         * 
-         * @return A new chromosome representing a 2-opt neighbor of the input chromosome.
+         * Runs the LS::Annealing engine, whose moves are evaluated by cost delta on the routes,
+         * then a SWAP* descent on its route state, capped at one step per temperature of the schedule.
+         *
+         * @param chromosome The chromosome on which simulated annealing will be applied.
          */
-        GA::Chromosome GenerateNeighborSwapStar(const GA::Chromosome&);
+        void SimulatedAnnealing(GA::Chromosome&);
     };
 }
 
@@ -0,0 +1,122 @@
+#ifndef MIGRATION_QUEUE_H
+#define MIGRATION_QUEUE_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "chromosome.hpp"
+
+namespace GA
+{
+    /**
+     * @brief Bounded lock-free queue of migrant chromosomes between islands.
+     *
+     * Multi-producer, multi-consumer ring buffer where every cell carries a sequence number
+     * (Vyukov's bounded queue). Producers and consumers claim cells with a compare-and-swap
+     * and never block; a push into a full queue fails and the migrant is dropped. Chromosomes
+     * are swapped in and out of the cells, so their buffers are recycled.
+     */
+    class MigrationQueue
+    {
+    public:
+        /**
+         * @param capacity Number of cells, rounded up to a power of two.
+         */
+        explicit MigrationQueue(size_t capacity)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+
+            this->m_mask = size - 1;
+            this->m_cells.reset(new Cell[size]);
+
+            for (size_t i = 0; i < size; ++i)
+                this->m_cells[i].sequence.store(i, std::memory_order_relaxed);
+
+            this->m_enqueue.store(0, std::memory_order_relaxed);
+            this->m_dequeue.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Copies a migrant into the queue.
+         *
+         * @return false if the queue is full.
+         */
+        inline bool TryPush(const Chromosome &migrant)
+        {
+            Cell *cell;
+            size_t pos = this->m_enqueue.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                cell = &this->m_cells[pos & this->m_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (this->m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = this->m_enqueue.load(std::memory_order_relaxed);
+            }
+
+            cell->migrant = migrant;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Takes the oldest migrant out of the queue.
+         *
+         * @param migrant Receives the migrant; its previous buffers stay in the queue for reuse.
+         *
+         * @return false if the queue is empty.
+         */
+        inline bool TryPop(Chromosome &migrant)
+        {
+            Cell *cell;
+            size_t pos = this->m_dequeue.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                cell = &this->m_cells[pos & this->m_mask];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+
+                if (diff == 0)
+                {
+                    if (this->m_dequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        break;
+                }
+                else if (diff < 0)
+                    return false;
+                else
+                    pos = this->m_dequeue.load(std::memory_order_relaxed);
+            }
+
+            std::swap(migrant, cell->migrant);
+            cell->sequence.store(pos + this->m_mask + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            Chromosome migrant;
+        };
+
+        std::unique_ptr<Cell[]> m_cells;
+        size_t m_mask;
+
+        alignas(64) std::atomic<size_t> m_enqueue;
+        alignas(64) std::atomic<size_t> m_dequeue;
+    };
+}
+
+#endif
@@ -1,8 +1,11 @@
 #ifndef POPULATION_H
 #define POPULATION_H
 #include "chromosome.hpp"
+#include "chromosome_pool.hpp"
+#include "hash_counter.hpp"
 #include <iomanip>
 #include <algorithm>
+#include <numeric>
 
 namespace GA
 {
@@ -19,7 +22,10 @@ namespace GA
         Population() : m_individuals(), m_size(0), m_generation(0) {}
 
         Population(std::vector<Chromosome> &individuals, int mSize, int mGeneration)
-            : m_individuals(individuals), m_size(mSize), m_generation(mGeneration) {}
+            : m_individuals(individuals), m_size(mSize), m_generation(mGeneration)
+        {
+            rebuildHashes();
+        }
 
         /**
          * @brief Prints the current population.
@@ -55,7 +61,7 @@ namespace GA
             {
                 if (individual.getFitness() == -1.0)
                 {
-                    individual.CalculateFitness(this->m_nodes, this->m_capacity);
+                    individual.CalculateFitness(this->m_nodes, *this->m_distances, this->m_capacity);
                 }
 
                 if (individual.getFitness() < this->getBestFitness())
@@ -66,27 +72,85 @@ namespace GA
         /**
          * @brief Performs the Survive Selection for next generation.
          *
-         * @param children Vector of child.
+         * Children are swapped into the population, so the replaced individuals go back to
+         * the pool and their buffers are reused by the next generation.
+         *
+         * @param children Pool of children.
          */
-        inline void SurviveSelection(std::vector<Chromosome> &children)
+        inline void SurviveSelection(ChromosomePool &children)
         {
             std::vector<Chromosome> &population = this->getIndividuals();
 
-            std::vector<int> index(population.size());
+            std::vector<int> &index = this->m_order;
+            index.resize(population.size());
             std::iota(index.begin(), index.end(), 0);
 
             std::sort(index.begin(), index.end(), [&population](int i1, int i2)
                       { return population[i1].getFitness() > population[i2].getFitness(); });
 
             for (size_t i = 0; i < children.size(); ++i)
-                if (!this->contains(children[i]))
-                    population[index[i]] = children[i];
+            {
+                if (this->contains(children[i]))
+                    continue;
+
+                this->m_hashes.erase(population[index[i]].getHash());
+                std::swap(population[index[i]], children[i]);
+                this->m_hashes.insert(population[index[i]].getHash());
+            }
 
             this->setGeneration(this->getGeneration() + 1);
         }
 
+        /**
+         * @brief Indices of the best individuals of the population.
+         *
+         * @param count Number of individuals.
+         * @param best Receives the indices, best first.
+         */
+        inline void BestIndices(int count, std::vector<int> &best) const
+        {
+            best.resize(this->m_individuals.size());
+            std::iota(best.begin(), best.end(), 0);
+
+            count = std::min(count, static_cast<int>(best.size()));
+            std::partial_sort(best.begin(), best.begin() + count, best.end(), [this](int i1, int i2)
+                              { return this->m_individuals[i1].getFitness() < this->m_individuals[i2].getFitness(); });
+            best.resize(count);
+        }
+
+        /**
+         * @brief Replaces the worst individual by a migrant from another population.
+         *
+         * @param migrant Evaluated chromosome; it receives the replaced individual.
+         *
+         * @return false if the migrant is already in the population or is not better than the worst one.
+         */
+        inline bool Immigrate(Chromosome &migrant)
+        {
+            if (this->m_individuals.empty() || this->contains(migrant))
+                return false;
+
+            auto worst = std::max_element(this->m_individuals.begin(), this->m_individuals.end(),
+                                          [](const Chromosome &a, const Chromosome &b)
+                                          { return a.getFitness() < b.getFitness(); });
+
+            if (worst->getFitness() <= migrant.getFitness())
+                return false;
+
+            this->m_hashes.erase(worst->getHash());
+            std::swap(*worst, migrant);
+            this->m_hashes.insert(worst->getHash());
+
+            if (worst->getFitness() < this->m_bestFitness)
+                this->m_bestFitness = worst->getFitness();
+
+            return true;
+        }
+
         /**
          * @brief Find if the given Individual is already in population.
+         *
+         * Looks up the DNA hash of the chromosome in the set of member hashes.
          * 
          * @param chromosome Chromosome to search for.
          * 
@@ -94,16 +158,23 @@ namespace GA
          */
         inline bool contains(const Chromosome &chromosome) const
         {
-            return std::find(m_individuals.begin(), m_individuals.end(), chromosome) != m_individuals.end();
+            return this->m_hashes.contains(chromosome.getHash());
         }
 
         // GETTERS AND SETTERS
         std::vector<Chromosome> &getIndividuals() { return this->m_individuals; }
-        void setIndividuals(const std::vector<Chromosome> &individuals) { this->m_individuals = individuals; }
+        void setIndividuals(const std::vector<Chromosome> &individuals)
+        {
+            this->m_individuals = individuals;
+            rebuildHashes();
+        }
 
         std::vector<Node> &getNodes() { return this->m_nodes; }
         void setNodes(const std::vector<Node> &nodes) { this->m_nodes = nodes; }
 
+        const DistanceMatrix& getDistances() const { return *this->m_distances; }
+        void setDistances(const DistanceMatrix* distances) { this->m_distances = distances; }
+
         int getSize() const { return this->m_size; }
         void setSize(int mSize) { this->m_size = mSize; }
 
@@ -122,12 +193,26 @@ namespace GA
     private:
         std::vector<Chromosome> m_individuals;
         std::vector<Node> m_nodes;
+        const DistanceMatrix* m_distances = nullptr;
 
         int m_size;
         int m_generation;
         double m_capacity;
         double m_bestFitness;
         double m_lastBestFitness;
+
+        // DNA hash of each member and how many members share it.
+        HashCounter m_hashes;
+
+        // Scratch buffer for SurviveSelection.
+        std::vector<int> m_order;
+
+        inline void rebuildHashes()
+        {
+            this->m_hashes.reset(this->m_individuals.size());
+            for (const auto &individual : this->m_individuals)
+                this->m_hashes.insert(individual.getHash());
+        }
     };
 }
 
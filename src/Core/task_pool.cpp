@@ -0,0 +1,165 @@
+#include "task_pool.hpp"
+#include "rng.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace GA
+{
+    void TaskPool::Start(int threads, uint64_t seed)
+    {
+        Stop();
+
+        threads = std::max(1, threads);
+        this->m_stop = false;
+        this->m_queues.clear();
+
+        for (int i = 0; i < threads; ++i)
+            this->m_queues.emplace_back(new Queue());
+
+        this->m_elapsed = 0;
+
+        for (int i = 1; i < threads; ++i)
+            this->m_threads.emplace_back(&TaskPool::WorkerLoop, this, i, seed);
+    }
+
+    void TaskPool::Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->m_mutex);
+            this->m_stop = true;
+        }
+        this->m_wake.notify_all();
+
+        for (auto& thread : this->m_threads)
+            thread.join();
+
+        this->m_threads.clear();
+    }
+
+    void TaskPool::Run(size_t count, const std::vector<double>* costs)
+    {
+        int participants = size();
+
+        // Pending is set before any task can be taken; the queues are published once filled.
+        this->m_pending.store(count, std::memory_order_relaxed);
+
+        if (costs == nullptr)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                Queue& queue = *this->m_queues[i % participants];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(i);
+            }
+        }
+        else
+        {
+            // Longest processing time first: the next largest task goes to the least loaded queue.
+            this->m_order.resize(count);
+            std::iota(this->m_order.begin(), this->m_order.end(), 0);
+            std::stable_sort(this->m_order.begin(), this->m_order.end(),
+                             [costs](size_t a, size_t b) { return (*costs)[a] > (*costs)[b]; });
+
+            this->m_loads.assign(participants, 0);
+
+            for (size_t i : this->m_order)
+            {
+                int target = static_cast<int>(std::min_element(this->m_loads.begin(), this->m_loads.end()) - this->m_loads.begin());
+                this->m_loads[target] += (*costs)[i];
+
+                Queue& queue = *this->m_queues[target];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                queue.tasks.push_back(i);
+            }
+        }
+
+        // Workers sleep until the queues are filled, so they do not steal from a partial
+        // assignment. A worker still scanning may take a task already, which subtracts from
+        // m_queued first; adding rather than storing keeps the count exact.
+        this->m_queued.fetch_add(count, std::memory_order_release);
+
+        // Taking the lock orders the update above with a worker checking it before sleeping.
+        {
+            std::lock_guard<std::mutex> lock(this->m_mutex);
+        }
+        this->m_wake.notify_all();
+
+        size_t task;
+        while (TakeTask(0, task))
+            Execute(0, task);
+
+        while (this->m_pending.load(std::memory_order_acquire) > 0)
+            std::this_thread::yield();
+    }
+
+    void TaskPool::WorkerLoop(int self, uint64_t seed)
+    {
+        utils::SetThreadSeed(seed, self);
+
+        while (true)
+        {
+            size_t task;
+            if (TakeTask(self, task))
+            {
+                Execute(self, task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->m_mutex);
+            this->m_wake.wait(lock, [this]() {
+                return this->m_stop || this->m_queued.load(std::memory_order_acquire) > 0;
+            });
+
+            if (this->m_stop)
+                return;
+        }
+    }
+
+    bool TaskPool::TakeTask(int self, size_t& task)
+    {
+        int participants = size();
+
+        for (int k = 0; k < participants; ++k)
+        {
+            Queue& queue = *this->m_queues[(self + k) % participants];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+
+            if (queue.head == queue.tasks.size())
+                continue;
+
+            // Own tasks are taken from the front, stolen ones from the back.
+            if (k == 0)
+                task = queue.tasks[queue.head++];
+            else
+            {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+                this->m_queues[self]->stats.stolen++;
+            }
+
+            if (queue.head == queue.tasks.size())
+            {
+                queue.tasks.clear();
+                queue.head = 0;
+            }
+
+            this->m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    void TaskPool::Execute(int self, size_t task)
+    {
+        auto start = std::chrono::steady_clock::now();
+        this->m_invoke(this->m_context, task);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        ThreadStats& stats = this->m_queues[self]->stats;
+        stats.busy += elapsed.count();
+        stats.tasks++;
+
+        this->m_pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GA
+{
+    /**
+     * @brief Persistent pool of worker threads with work stealing.
+     *
+     * The workers are started once and sleep between jobs, so a generation does not pay for
+     * creating a thread team. Each participant (the calling thread is participant 0) owns a
+     * queue of task indices: it takes work from the front of its own queue and, once that is
+     * empty, steals from the back of the others. The only synchronization point of a job is
+     * the wait for its last task.
+     *
+     * When the tasks come with cost estimates, they are dealt largest first to the least loaded
+     * queue, so every participant starts with its most expensive tasks and steals are left with
+     * the cheap ones.
+     */
+    class TaskPool
+    {
+    public:
+        /**
+         * @brief Work done by one participant since Start.
+         */
+        struct ThreadStats
+        {
+            double busy = 0;     // Seconds spent running tasks.
+            size_t tasks = 0;
+            size_t stolen = 0;   // Tasks taken from the queue of another participant.
+        };
+
+        TaskPool() : m_invoke(nullptr), m_context(nullptr), m_queued(0), m_pending(0), m_stop(false) {}
+        ~TaskPool() { Stop(); }
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        /**
+         * @brief Starts the workers, stopping the previous ones.
+         *
+         * @param threads Number of participants, counting the calling thread.
+         * @param seed Seed of the random generators of the workers; worker w uses substream w.
+         */
+        void Start(int threads, uint64_t seed);
+
+        /**
+         * @brief Stops and joins the workers.
+         */
+        void Stop();
+
+        int size() const { return static_cast<int>(this->m_queues.size()); }
+
+        const ThreadStats& getStats(int participant) const { return this->m_queues[participant]->stats; }
+
+        /**
+         * @brief Seconds spent inside ParallelFor since Start.
+         */
+        double getElapsed() const { return this->m_elapsed; }
+
+        /**
+         * @brief Calls fn(i) for every i in [0, count) and returns once all calls finished.
+         *
+         * The calling thread runs tasks too. Calls may run in any order and on any thread.
+         *
+         * @param count Number of tasks.
+         * @param fn Task body.
+         * @param costs Optional estimated cost of every task, used to balance the queues.
+         */
+        template <typename Function>
+        void ParallelFor(size_t count, Function& fn, const std::vector<double>* costs = nullptr)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            if (this->m_threads.empty())
+            {
+                for (size_t i = 0; i < count; ++i)
+                    fn(i);
+
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                this->m_queues[0]->stats.busy += elapsed.count();
+                this->m_queues[0]->stats.tasks += count;
+                this->m_elapsed += elapsed.count();
+                return;
+            }
+
+            this->m_invoke = [](void* context, size_t i) { (*static_cast<Function*>(context))(i); };
+            this->m_context = &fn;
+            Run(count, costs);
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            this->m_elapsed += elapsed.count();
+        }
+
+    private:
+        struct alignas(64) Queue
+        {
+            std::mutex mutex;
+            std::vector<size_t> tasks;   // Tasks left are tasks[head, end); the buffer is reused.
+            size_t head = 0;
+            ThreadStats stats;           // Only updated by the owner of the queue.
+        };
+
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        void (*m_invoke)(void*, size_t);
+        void* m_context;
+
+        std::atomic<size_t> m_queued;    // Tasks not taken yet.
+        std::atomic<size_t> m_pending;   // Tasks not finished yet.
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stop;
+
+        double m_elapsed = 0;
+
+        // Buffers of the cost-balanced distribution.
+        std::vector<size_t> m_order;
+        std::vector<double> m_loads;
+
+        /**
+         * @brief Distributes the tasks, runs them with the workers and waits for the last one.
+         */
+        void Run(size_t count, const std::vector<double>* costs);
+
+        void WorkerLoop(int self, uint64_t seed);
+
+        /**
+         * @brief Takes a task from the queue of a participant, or steals one from another queue.
+         *
+         * @return false if every queue is empty.
+         */
+        bool TakeTask(int self, size_t& task);
+
+        void Execute(int self, size_t task);
+    };
+}
+
+#endif
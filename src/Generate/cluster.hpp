@@ -12,32 +12,33 @@ namespace GEN
         Cluster(double centroid_x, double centroid_y)
             : m_centroid_x(centroid_x), m_centroid_y(centroid_y) {}
 
+        /**
+         * @brief Adds a node and moves the centroid to the mean of the nodes, in O(1).
+         */
         inline void addNode(const Node& node)
         {
             this->m_nodes.push_back(node);
+            this->m_sum_x += node.getX();
+            this->m_sum_y += node.getY();
             updateCentroid();
         }
 
+        /**
+         * @brief Removes the nodes; the centroid stays where it was.
+         */
         inline void clear()
         {
             this->m_nodes.clear();
+            this->m_sum_x = 0;
+            this->m_sum_y = 0;
         }
 
         inline void updateCentroid()
         {
             if (this->m_nodes.empty()) return;
 
-            double sum_x = 0;
-            double sum_y = 0;
-
-            for (const auto& node : this->m_nodes)
-            {
-                sum_x += node.getX();
-                sum_y += node.getY();
-            }
-
-            this->m_centroid_x = sum_x / this->m_nodes.size();
-            this->m_centroid_y = sum_y / this->m_nodes.size();
+            this->m_centroid_x = this->m_sum_x / this->m_nodes.size();
+            this->m_centroid_y = this->m_sum_y / this->m_nodes.size();
         }
 
         void setCentroid(double centroid_x, double centroid_y) 
@@ -55,6 +56,8 @@ namespace GEN
         std::vector<Node> m_nodes;
         double m_centroid_x = 0;
         double m_centroid_y = 0;
+        double m_sum_x = 0;
+        double m_sum_y = 0;
     };
 }
 
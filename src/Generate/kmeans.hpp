@@ -1,11 +1,11 @@
 #ifndef KMEANS_H
 #define KMEANS_H
 
+#include <algorithm>
 #include <vector>
-#include <limits>
-#include <unordered_set>
 #include "node.hpp"
 #include "utils.hpp"
+#include "simd_kernels.hpp"
 #include "cluster.hpp"
 
 namespace GEN 
@@ -13,33 +13,53 @@ namespace GEN
     class KMeans
     {
     public:
+        /**
+         * @param k Number of clusters, capped to the number of customers.
+         * @param nodes Nodes of the instance; must outlive the object.
+         * @param max_x Bound of the coordinates, for the reset of empty clusters.
+         * @param max_y
+         */
         KMeans(int k, const std::vector<Node>& nodes, int max_x, int max_y)
-            : k(k), m_nodes(nodes), m_max_x(max_x), m_max_y(max_y) {}
+            : k(k), m_nodes(nodes), m_max_x(max_x), m_max_y(max_y)
+        {
+            // Coordinates of the customers (the depot has id 1) as separate arrays for the kernels.
+            for (const auto& node : this->m_nodes)
+            {
+                if (node.getId() == 1) continue;
+
+                this->m_customers.push_back(&node - this->m_nodes.data());
+                this->m_xs.push_back(node.getX());
+                this->m_ys.push_back(node.getY());
+            }
+
+            this->k = std::max(1, std::min(this->k, static_cast<int>(this->m_customers.size())));
+        }
 
+        /**
+         * @brief Runs Lloyd's iterations until no customer changes cluster.
+         *
+         * @param max_iters
+         */
         inline void run(int max_iters = 100)
         {
             initializeClusters();
 
             for (int iter = 0; iter < max_iters; ++iter)
             {
-                createClusters();
+                bool changed = createClusters();
 
                 for (auto& cluster : this->m_clusters)
                 {
                     if (cluster.getNodes().empty())
                     {
-                        cluster.clear();
                         double rand_x = utils::randDouble(0, this->m_max_x);
                         double rand_y = utils::randDouble(0, this->m_max_y);
                         cluster.setCentroid(rand_x, rand_y);
-                    }
-                    else
-                    {
-                        cluster.updateCentroid();
+                        changed = true;
                     }
                 }
 
-                if (isConverged())
+                if (!changed)
                     break;
             }
         }
@@ -48,65 +68,66 @@ namespace GEN
 
     private:
         int k;
-        std::vector<Node> m_nodes;
+        const std::vector<Node>& m_nodes;
         std::vector<Cluster> m_clusters;
+        std::vector<size_t> m_customers;
+        std::vector<double> m_xs;
+        std::vector<double> m_ys;
+        std::vector<double> m_centroidXs;
+        std::vector<double> m_centroidYs;
+        std::vector<int> m_assignment;
+        std::vector<int> m_previous;
         int m_max_x = 0;
         int m_max_y = 0;
 
+        /**
+         * @brief Starts the centroids at k distinct customers drawn at random.
+         */
         inline void initializeClusters()
         {
-           this->m_clusters.clear();
+            this->m_clusters.clear();
+            this->m_assignment.clear();
+
+            std::vector<size_t> order(this->m_customers.size());
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
 
             for (int i = 0; i < k; ++i)
             {
-                double rand_x = utils::randDouble(0, this->m_max_x);
-                double rand_y = utils::randDouble(0, this->m_max_y);
-                Cluster cluster(rand_x, rand_y);
-                this->m_clusters.push_back(cluster);
+                std::swap(order[i], order[utils::randInteger(i, static_cast<int>(order.size()) - 1)]);
+                this->m_clusters.emplace_back(this->m_xs[order[i]], this->m_ys[order[i]]);
             }
         }
 
-        inline void createClusters()
+        /**
+         * @brief Assigns every customer to the closest centroid and moves the centroids to the means.
+         *
+         * @return true if some customer changed cluster.
+         */
+        inline bool createClusters()
         {
-            for (auto& cluster: this->m_clusters)
-                cluster.clear();
+            this->m_centroidXs.resize(k);
+            this->m_centroidYs.resize(k);
 
-            for (const auto& node : this->m_nodes)
+            for (int i = 0; i < k; ++i)
             {
-                if (node.getId() == 1) continue;
+                this->m_clusters[i].clear();
+                this->m_centroidXs[i] = this->m_clusters[i].getCentroidX();
+                this->m_centroidYs[i] = this->m_clusters[i].getCentroidY();
+            }
 
-                int best_cluster_index = 0;
-                double min_distance = std::numeric_limits<double>::infinity();
+            // Every customer goes to the closest of the centroids of the previous step.
+            this->m_previous.swap(this->m_assignment);
+            this->m_assignment.resize(this->m_customers.size());
+            utils::AssignNearest(this->m_xs.data(), this->m_ys.data(), this->m_customers.size(),
+                                 this->m_centroidXs.data(), this->m_centroidYs.data(), k, this->m_assignment.data());
 
-                for (int i = 0; i < k; ++i)
-                {
-                    double dist = utils::EuclidianDistance(
-                        node.getX(), this->m_clusters[i].getCentroidX(),
-                        node.getY(), this->m_clusters[i].getCentroidY());
+            for (size_t i = 0; i < this->m_customers.size(); ++i)
+                this->m_clusters[this->m_assignment[i]].addNode(this->m_nodes[this->m_customers[i]]);
 
-                    if (dist < min_distance)
-                    {
-                        min_distance = dist;
-                        best_cluster_index = i;
-                    }
-                }
-
-                this->m_clusters[best_cluster_index].addNode(node);
-            }
-        }
-
-        inline bool isConverged()
-        {
-            for (int i = 1; i < k; ++i)
-            {
-                if (this->m_clusters[i].getCentroidX() != this->m_clusters[i - 1].getCentroidX() ||
-                    this->m_clusters[i].getCentroidY() != this->m_clusters[i - 1].getCentroidY()) {
-                    return false;
-                }
-            }
-            return true;
+            return this->m_assignment != this->m_previous;
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
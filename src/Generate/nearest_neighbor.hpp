@@ -1,7 +1,11 @@
 #ifndef NEAREST_NEIGHBOR_H
 #define NEAREST_NEIGHBOR_H
 
+#include <algorithm>
+#include <cmath>
 #include "kmeans.hpp"
+#include "simd_kernels.hpp"
+#include "spatial_grid.hpp"
 #include "../Core/chromosome.hpp"
 
 namespace GEN
@@ -9,93 +13,134 @@ namespace GEN
     class NearestNeighbor
     {
     public:
-        NearestNeighbor(const std::vector<Cluster>& clusters)
-            : m_clusters(clusters) {}
-
+        /**
+         * @param clusters Clusters of the customers; must outlive the object, and can be shared
+         * by several objects.
+         * @param depot Depot of the instance, around which the clusters are ordered.
+         */
+        NearestNeighbor(const std::vector<Cluster>& clusters, const Node& depot)
+            : m_clusters(clusters), m_depot_x(depot.getX()), m_depot_y(depot.getY()) {}
+
+        /**
+         * @brief Builds the DNA as the concatenation of one nearest neighbor tour per cluster.
+         *
+         * The clusters are visited by the angle of their centroid around the depot, from a random
+         * cluster and in a random direction, and each tour, from a random customer, is reversed
+         * with probability 1/2. So several runs on the same clusters give different individuals,
+         * while neighboring clusters stay next to each other in the DNA.
+         */
         inline void run()
         {
-            for (auto& cluster : this->m_clusters)
+            this->m_order.resize(this->m_clusters.size());
+            for (size_t i = 0; i < this->m_order.size(); ++i)
+                this->m_order[i] = i;
+
+            std::vector<double> angles(this->m_clusters.size());
+            for (size_t i = 0; i < angles.size(); ++i)
+                angles[i] = std::atan2(this->m_clusters[i].getCentroidY() - this->m_depot_y,
+                                       this->m_clusters[i].getCentroidX() - this->m_depot_x);
+
+            std::sort(this->m_order.begin(), this->m_order.end(),
+                      [&angles](size_t a, size_t b) { return angles[a] < angles[b]; });
+
+            if (!this->m_order.empty())
+                std::rotate(this->m_order.begin(),
+                            this->m_order.begin() + utils::randInteger(0, static_cast<int>(this->m_order.size()) - 1),
+                            this->m_order.end());
+            if (utils::randInteger(0, 1))
+                std::reverse(this->m_order.begin(), this->m_order.end());
+
+            for (size_t c : this->m_order)
             {
-                std::vector<int> dna = createPartialDna(cluster);
-                m_dna.insert(this->m_dna.end(), dna.begin(), dna.end());
+                size_t first = this->m_dna.size();
+                createPartialDna(this->m_clusters[c]);
+
+                if (utils::randInteger(0, 1))
+                    std::reverse(this->m_dna.begin() + first, this->m_dna.end());
             }
         }
         
-        const std::vector<int>& getDna() const { return this->m_dna; }
+        const std::vector<gene_t>& getDna() const { return this->m_dna; }
 
     private:
-        std::vector<int> m_dna;
-        std::vector<Cluster> m_clusters;
-
-        inline std::vector<int> createPartialDna(const Cluster &cluster)
+        // Clusters up to this size are scanned with the SIMD kernel; larger ones go through a spatial grid.
+        static constexpr size_t GRID_THRESHOLD = 128;
+
+        std::vector<gene_t> m_dna;
+        const std::vector<Cluster>& m_clusters;
+        double m_depot_x;
+        double m_depot_y;
+        std::vector<size_t> m_order;
+
+        // Customers of the current cluster; the scan drops visited ones by swapping them with the last.
+        std::vector<int> m_ids;
+        std::vector<double> m_xs;
+        std::vector<double> m_ys;
+        SpatialGrid m_grid;
+
+        /**
+         * @brief Appends the nearest neighbor tour of a cluster, from a random customer, to the DNA.
+         *
+         * Distances are compared on the coordinates, as squared Euclidean distances.
+         */
+        inline void createPartialDna(const Cluster &cluster)
         {
-            std::unordered_set<int> unvisited_nodes;
-            std::vector<int> dna;
+            this->m_ids.clear();
+            this->m_xs.clear();
+            this->m_ys.clear();
 
             for (auto &node : cluster.getNodes())
             {
-                if (node.getId() != 1)
-                    unvisited_nodes.insert(node.getId() - 1);
-            }
+                if (node.getId() == 1) continue;
 
-            if (unvisited_nodes.empty())
-                throw std::runtime_error("Error: Cluster is empty. No nodes to visit.");
-
-            int current_node_id = *std::next(unvisited_nodes.begin(), utils::randInteger(0, unvisited_nodes.size() - 1));
-            unvisited_nodes.erase(current_node_id);
-            dna.push_back(current_node_id);
-
-            while (!unvisited_nodes.empty())
-            {
-                int nearest_node_id = findNearestNeighbor(current_node_id, unvisited_nodes, cluster.getNodes());
-                dna.push_back(nearest_node_id);
-                unvisited_nodes.erase(nearest_node_id);
-                current_node_id = nearest_node_id;
+                this->m_ids.push_back(node.getId() - 1);
+                this->m_xs.push_back(node.getX());
+                this->m_ys.push_back(node.getY());
             }
 
-            return dna;
-        }
-
-        inline int
-        findNearestNeighbor(int current_node_id, const std::unordered_set<int>& unvisited_nodes, const std::vector<Node>& nodes)
-        {
-            if (unvisited_nodes.empty())
-                throw std::runtime_error("Error: unvisited_nodes is empty.");
-
-            int nearest_node_id = -1;
-            double min_distance = std::numeric_limits<double>::max();
+            if (this->m_ids.empty())
+                return;
 
-            const Node& current_node = getNodeById(current_node_id, nodes);
+            size_t next = utils::randInteger(0, static_cast<int>(this->m_ids.size()) - 1);
 
-            for (int node_id : unvisited_nodes)
+            if (this->m_ids.size() > GRID_THRESHOLD)
             {
-                const Node& target_node = getNodeById(node_id, nodes);
-
-                double dist = utils::EuclidianDistance(
-                    current_node.getX(), target_node.getX(),
-                    current_node.getY(), target_node.getY());
+                this->m_grid.Build(this->m_xs.data(), this->m_ys.data(), this->m_ids.size());
 
-                if (dist < min_distance)
+                for (int current = static_cast<int>(next); current >= 0; )
                 {
-                    min_distance = dist;
-                    nearest_node_id = node_id;
+                    this->m_dna.push_back(this->m_ids[current]);
+                    this->m_grid.Remove(current);
+                    current = this->m_grid.Nearest(this->m_xs[current], this->m_ys[current]);
                 }
+
+                return;
             }
 
-            if (nearest_node_id == -1)
-                throw std::runtime_error("Error: No valid nearest neighbor found.");
+            while (true)
+            {
+                double x = this->m_xs[next];
+                double y = this->m_ys[next];
+                this->m_dna.push_back(this->m_ids[next]);
+                remove(next);
+
+                if (this->m_ids.empty())
+                    break;
 
-            return nearest_node_id;
+                next = utils::ArgminSquaredDistance(this->m_xs.data(), this->m_ys.data(), this->m_ids.size(), x, y);
+            }
         }
 
-        inline const Node& getNodeById(int id, const std::vector<Node>& nodes)
+        inline void remove(size_t index)
         {
-            for (const auto& node : nodes)
-                if (node.getId() == id + 1)
-                    return node;
-            throw std::runtime_error("Error: Node ID not found in nodes.");
+            this->m_ids[index] = this->m_ids.back();
+            this->m_xs[index] = this->m_xs.back();
+            this->m_ys[index] = this->m_ys.back();
+            this->m_ids.pop_back();
+            this->m_xs.pop_back();
+            this->m_ys.pop_back();
         }
     };
 }
 
-#endif
\ No newline at end of file
+#endif
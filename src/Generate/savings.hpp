@@ -0,0 +1,164 @@
+#ifndef SAVINGS_H
+#define SAVINGS_H
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "node.hpp"
+#include "utils.hpp"
+#include "distance_matrix.hpp"
+#include "neighbor_lists.hpp"
+#include "../Core/chromosome.hpp"
+
+namespace GEN
+{
+    /**
+     * @brief Clarke-Wright savings constructor.
+     *
+     * Starts from one route per customer and merges routes by decreasing saving
+     * s(i, j) = d(0, i) + d(0, j) - lambda * d(i, j), as long as i and j are ends of different
+     * routes and the merged load fits the capacity. Only the pairs of the neighbor lists are
+     * considered, popped from a heap, so a run costs O(n k log(n k)). Routes are kept as
+     * undirected chains (two links per customer) and a union-find gives the route of a customer,
+     * so a merge is O(1) whatever the orientation of the two routes.
+     *
+     * lambda is drawn in [0.6, 1.4] and every saving is scaled by a random factor in [1, 1.05],
+     * so several runs give different solutions. The DNA is the concatenation of the routes.
+     */
+    class Savings
+    {
+    public:
+        /**
+         * @param nodes Nodes of the instance, indexed as in the DNA (0 is the depot).
+         * @param distances
+         * @param neighbors Neighbor lists; their pairs are the merge candidates.
+         * @param capacity
+         */
+        Savings(const std::vector<Node>& nodes, const DistanceMatrix& distances, const NeighborLists& neighbors,
+                double capacity)
+            : m_nodes(nodes), m_distances(distances), m_neighbors(neighbors), m_capacity(capacity) {}
+
+        inline void run()
+        {
+            int n = static_cast<int>(this->m_nodes.size());
+            double lambda = utils::randDouble(0.6, 1.4);
+
+            this->m_heap.clear();
+            for (int i = 1; i < n; ++i)
+            {
+                const int* list = this->m_neighbors.of(i);
+                for (int c = 0; c < this->m_neighbors.k(); ++c)
+                {
+                    int j = list[c];
+                    // Each pair once, unless only one side has the other in its list.
+                    if (j < i && contains(j, i))
+                        continue;
+
+                    double saving = this->m_distances(0, i) + this->m_distances(0, j) - lambda * this->m_distances(i, j);
+                    this->m_heap.push_back(Candidate{ saving * utils::randDouble(1.0, 1.05), i, j });
+                }
+            }
+            std::make_heap(this->m_heap.begin(), this->m_heap.end());
+
+            this->m_link.assign(2 * n, 0);
+            this->m_parent.resize(n);
+            std::iota(this->m_parent.begin(), this->m_parent.end(), 0);
+            this->m_load.resize(n);
+            for (int i = 0; i < n; ++i)
+                this->m_load[i] = this->m_nodes[i].getDemand();
+
+            while (!this->m_heap.empty())
+            {
+                std::pop_heap(this->m_heap.begin(), this->m_heap.end());
+                Candidate candidate = this->m_heap.back();
+                this->m_heap.pop_back();
+
+                if (candidate.saving <= 0)
+                    break;
+
+                int i = candidate.i, j = candidate.j;
+                int ri = find(i), rj = find(j);
+
+                if (ri == rj || !isEnd(i) || !isEnd(j) || this->m_load[ri] + this->m_load[rj] > this->m_capacity)
+                    continue;
+
+                link(i, j);
+                link(j, i);
+                this->m_parent[rj] = ri;
+                this->m_load[ri] += this->m_load[rj];
+            }
+
+            exportRoutes(n);
+        }
+
+        const std::vector<gene_t>& getDna() const { return this->m_dna; }
+
+    private:
+        struct Candidate
+        {
+            double saving;
+            int i;
+            int j;
+
+            bool operator<(const Candidate& other) const { return saving < other.saving; }
+        };
+
+        const std::vector<Node>& m_nodes;
+        const DistanceMatrix& m_distances;
+        const NeighborLists& m_neighbors;
+        double m_capacity;
+
+        std::vector<Candidate> m_heap;
+        std::vector<int> m_link;      // Two neighbors in the route per customer, 0 for the depot.
+        std::vector<int> m_parent;
+        std::vector<double> m_load;   // Load of a route, at its union-find root.
+        std::vector<gene_t> m_dna;
+
+        inline bool contains(int i, int j) const
+        {
+            const int* list = this->m_neighbors.of(i);
+            return std::find(list, list + this->m_neighbors.k(), j) != list + this->m_neighbors.k();
+        }
+
+        inline int find(int i)
+        {
+            while (this->m_parent[i] != i)
+            {
+                this->m_parent[i] = this->m_parent[this->m_parent[i]];
+                i = this->m_parent[i];
+            }
+            return i;
+        }
+
+        bool isEnd(int i) const { return this->m_link[2 * i] == 0 || this->m_link[2 * i + 1] == 0; }
+
+        void link(int i, int j) { this->m_link[2 * i + (this->m_link[2 * i] == 0 ? 0 : 1)] = j; }
+
+        /**
+         * @brief Walks every route from one of its ends and appends it to the DNA.
+         */
+        inline void exportRoutes(int n)
+        {
+            this->m_dna.clear();
+            std::vector<char> visited(n, 0);
+
+            for (int start = 1; start < n; ++start)
+            {
+                if (visited[start] || !isEnd(start))
+                    continue;
+
+                for (int prev = 0, x = start; x != 0; )
+                {
+                    visited[x] = 1;
+                    this->m_dna.push_back(static_cast<gene_t>(x));
+
+                    int next = this->m_link[2 * x] != prev ? this->m_link[2 * x] : this->m_link[2 * x + 1];
+                    prev = x;
+                    x = next;
+                }
+            }
+        }
+    };
+}
+
+#endif
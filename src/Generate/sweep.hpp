@@ -0,0 +1,63 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "node.hpp"
+#include "utils.hpp"
+#include "../Core/chromosome.hpp"
+
+namespace GEN
+{
+    /**
+     * @brief Sweep constructor.
+     *
+     * Orders the customers by polar angle around the depot (sorted once, in O(n log n)); each
+     * run rotates that order to a random first customer and picks a random direction. Split
+     * then cuts the sweep into routes.
+     */
+    class Sweep
+    {
+    public:
+        /**
+         * @param nodes Nodes of the instance, indexed as in the DNA (0 is the depot).
+         */
+        explicit Sweep(const std::vector<Node>& nodes)
+        {
+            double depot_x = nodes[0].getX();
+            double depot_y = nodes[0].getY();
+
+            std::vector<double> angles(nodes.size());
+            for (size_t i = 1; i < nodes.size(); ++i)
+                angles[i] = std::atan2(nodes[i].getY() - depot_y, nodes[i].getX() - depot_x);
+
+            this->m_order.resize(nodes.size() - 1);
+            std::iota(this->m_order.begin(), this->m_order.end(), 1);
+            std::sort(this->m_order.begin(), this->m_order.end(),
+                      [&angles](gene_t a, gene_t b) { return angles[a] < angles[b]; });
+        }
+
+        inline void run()
+        {
+            this->m_dna = this->m_order;
+            if (this->m_dna.empty())
+                return;
+
+            std::rotate(this->m_dna.begin(),
+                        this->m_dna.begin() + utils::randInteger(0, static_cast<int>(this->m_dna.size()) - 1),
+                        this->m_dna.end());
+            if (utils::randInteger(0, 1))
+                std::reverse(this->m_dna.begin(), this->m_dna.end());
+        }
+
+        const std::vector<gene_t>& getDna() const { return this->m_dna; }
+
+    private:
+        std::vector<gene_t> m_order;
+        std::vector<gene_t> m_dna;
+    };
+}
+
+#endif
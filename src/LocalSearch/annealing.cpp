@@ -0,0 +1,439 @@
+#include "annealing.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace LS
+{
+    int Annealing::Run(GA::Chromosome &chromosome, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                       const NeighborLists &neighbors, int capacity, const AnnealingSchedule &schedule)
+    {
+        this->m_nodes = &nodes;
+        this->m_distances = &distances;
+        this->m_capacity = capacity;
+
+        Load(chromosome);
+        this->m_undo.clear();
+
+        int customers = static_cast<int>(chromosome.getDNA().size());
+        if (customers < 2)
+            return 0;
+
+        int steps = schedule.steps > 0 ? schedule.steps : customers;
+        double bestCost = this->m_cost;
+        int accepted = 0;
+
+        for (double temperature = schedule.temperature; temperature > schedule.minTemperature; temperature *= schedule.cooling)
+        {
+            for (int step = 0; step < steps; ++step)
+            {
+                int u = utils::randInteger(1, customers);
+                int v;
+
+                if (neighbors.k() > 0)
+                    v = neighbors.of(u)[utils::randInteger(0, neighbors.k() - 1)];
+                else
+                {
+                    v = utils::randInteger(1, customers - 1);
+                    if (v >= u)
+                        v++;
+                }
+
+                if (!TryMove(u, v, temperature))
+                    continue;
+
+                accepted++;
+
+                if (this->m_cost < bestCost - 1e-9)
+                {
+                    bestCost = this->m_cost;
+                    this->m_undo.clear();
+                }
+            }
+        }
+
+        for (auto it = this->m_undo.rbegin(); it != this->m_undo.rend(); ++it)
+            Undo(*it);
+        this->m_undo.clear();
+        this->m_cost = bestCost;
+
+        if (schedule.swapStar > 0)
+        {
+            // The annealing moves changed the routes without versioning them.
+            this->m_versions.resize(this->m_routes.size());
+            for (uint64_t &version : this->m_versions)
+                version = ++this->m_nextVersion;
+
+            this->m_insertions.Prepare(customers, this->m_routes.size(), static_cast<size_t>(neighbors.k()));
+
+            size_t routes = this->m_routes.size();
+            this->m_pairMoves.resize(routes * (routes - 1) / 2);
+            this->m_changed.assign(routes, 1);
+
+            for (int step = 0; step < schedule.swapStar && SwapStar(neighbors); ++step)
+                ;
+        }
+
+        Export(chromosome);
+        chromosome.CalculateFitness(nodes, distances, capacity);
+        return accepted;
+    }
+
+    void Annealing::Load(const GA::Chromosome &chromosome)
+    {
+        const std::vector<GA::Route> &routes = chromosome.getRoutes();
+        const std::vector<gene_t> &dna = chromosome.getDNA();
+
+        // Route buffers are reused; only their contents change.
+        if (this->m_routes.size() < routes.size())
+            this->m_routes.resize(routes.size());
+        for (size_t r = routes.size(); r < this->m_routes.size(); ++r)
+            this->m_routes[r].clear();
+
+        this->m_loads.assign(this->m_routes.size(), 0);
+        this->m_routeOf.resize(dna.size() + 1);
+        this->m_positionOf.resize(dna.size() + 1);
+        this->m_cost = 0;
+
+        for (size_t r = 0; r < routes.size(); ++r)
+        {
+            std::vector<int> &route = this->m_routes[r];
+            route.assign(chromosome.routeGenes(routes[r]), chromosome.routeGenes(routes[r]) + routes[r].size());
+
+            this->m_loads[r] = routes[r].load;
+            this->m_cost += routes[r].cost;
+            Renumber(static_cast<int>(r), 0);
+        }
+    }
+
+    void Annealing::Export(GA::Chromosome &chromosome) const
+    {
+        thread_local std::vector<gene_t> dna;
+        dna.clear();
+
+        for (const std::vector<int> &route : this->m_routes)
+            for (int x : route)
+                dna.push_back(static_cast<gene_t>(x));
+
+        chromosome.setDNA(dna);
+    }
+
+    bool Annealing::Accept(double delta, double temperature) const
+    {
+        return delta < 0 || utils::randDouble(0, 1) < std::exp(-delta / temperature);
+    }
+
+    bool Annealing::TryMove(int u, int v, double temperature)
+    {
+        if (u == v)
+            return false;
+
+        int ru = this->m_routeOf[u];
+        int rv = this->m_routeOf[v];
+        int pu = pred(u), su = succ(u);
+        int pv = pred(v), sv = succ(v);
+
+        switch (utils::randInteger(0, 2))
+        {
+        case 0:
+        {
+            // Relocate u right after v.
+            if (pu == v)
+                return false;
+            if (su == v)
+            {
+                // u and v are consecutive: moving u after v is a swap of the two.
+                double delta = d(pu, v) + d(u, sv) - d(pu, u) - d(v, sv);
+                if (!Accept(delta, temperature))
+                    return false;
+
+                Swap(u, v);
+                this->m_cost += delta;
+                this->m_undo.push_back(Move{ MoveType::Swap, u, v, 0, 0, 0 });
+                return true;
+            }
+
+            if (ru != rv && this->m_loads[rv] + demand(u) > this->m_capacity)
+                return false;
+
+            double delta = d(pu, su) - d(pu, u) - d(u, su) + d(v, u) + d(u, sv) - d(v, sv);
+            if (!Accept(delta, temperature))
+                return false;
+
+            Move move{ MoveType::Relocate, u, 0, ru, this->m_positionOf[u], 0 };
+
+            int position = this->m_positionOf[v] + 1;
+            if (ru == rv && this->m_positionOf[u] < this->m_positionOf[v])
+                position--;
+
+            Relocate(u, rv, position);
+            this->m_cost += delta;
+            this->m_undo.push_back(move);
+            return true;
+        }
+        case 1:
+        {
+            if (ru != rv && (this->m_loads[ru] - demand(u) + demand(v) > this->m_capacity ||
+                             this->m_loads[rv] - demand(v) + demand(u) > this->m_capacity))
+                return false;
+
+            double delta;
+            if (su == v)
+                delta = d(pu, v) + d(u, sv) - d(pu, u) - d(v, sv);
+            else if (sv == u)
+                delta = d(pv, u) + d(v, su) - d(pv, v) - d(u, su);
+            else
+                delta = d(pu, v) + d(v, su) + d(pv, u) + d(u, sv) - d(pu, u) - d(u, su) - d(pv, v) - d(v, sv);
+
+            if (!Accept(delta, temperature))
+                return false;
+
+            Swap(u, v);
+            this->m_cost += delta;
+            this->m_undo.push_back(Move{ MoveType::Swap, u, v, 0, 0, 0 });
+            return true;
+        }
+        default:
+        {
+            if (ru != rv)
+                return false;
+
+            int first = std::min(this->m_positionOf[u], this->m_positionOf[v]);
+            int last = std::max(this->m_positionOf[u], this->m_positionOf[v]);
+            const std::vector<int> &route = this->m_routes[ru];
+
+            int a = route[first], b = route[last];
+            int before = first > 0 ? route[first - 1] : 0;
+            int after = last + 1 < static_cast<int>(route.size()) ? route[last + 1] : 0;
+
+            double delta = d(before, b) + d(a, after) - d(before, a) - d(b, after);
+            if (!Accept(delta, temperature))
+                return false;
+
+            Reverse(ru, first, last);
+            this->m_cost += delta;
+            this->m_undo.push_back(Move{ MoveType::Reverse, 0, 0, ru, first, last });
+            return true;
+        }
+        }
+    }
+
+    void Annealing::Relocate(int u, int to, int position)
+    {
+        int from = this->m_routeOf[u];
+        std::vector<int> &source = this->m_routes[from];
+        int old = this->m_positionOf[u];
+
+        source.erase(source.begin() + old);
+        this->m_loads[from] -= demand(u);
+
+        std::vector<int> &target = this->m_routes[to];
+        target.insert(target.begin() + position, u);
+        this->m_loads[to] += demand(u);
+
+        if (from == to)
+            Renumber(to, std::min(old, position));
+        else
+        {
+            Renumber(from, old);
+            Renumber(to, position);
+        }
+    }
+
+    void Annealing::Swap(int u, int v)
+    {
+        int ru = this->m_routeOf[u], rv = this->m_routeOf[v];
+        int pu = this->m_positionOf[u], pv = this->m_positionOf[v];
+
+        this->m_routes[ru][pu] = v;
+        this->m_routes[rv][pv] = u;
+
+        this->m_routeOf[u] = rv;
+        this->m_positionOf[u] = pv;
+        this->m_routeOf[v] = ru;
+        this->m_positionOf[v] = pu;
+
+        if (ru != rv)
+        {
+            this->m_loads[ru] += demand(v) - demand(u);
+            this->m_loads[rv] += demand(u) - demand(v);
+        }
+    }
+
+    void Annealing::Reverse(int route, int first, int last)
+    {
+        std::vector<int> &customers = this->m_routes[route];
+        std::reverse(customers.begin() + first, customers.begin() + last + 1);
+
+        for (int p = first; p <= last; ++p)
+            this->m_positionOf[customers[p]] = p;
+    }
+
+    void Annealing::Undo(const Move &move)
+    {
+        switch (move.type)
+        {
+        case MoveType::Relocate:
+            Relocate(move.u, move.route, move.position);
+            break;
+        case MoveType::Swap:
+            Swap(move.u, move.v);
+            break;
+        case MoveType::Reverse:
+            Reverse(move.route, move.position, move.end);
+            break;
+        }
+    }
+
+    bool Annealing::SwapStar(const NeighborLists &neighbors)
+    {
+        const double epsilon = 1e-9;
+        int routes = static_cast<int>(this->m_routes.size());
+
+        for (int r2 = 1; r2 < routes; ++r2)
+            for (int r1 = 0; r1 < r2; ++r1)
+                if (this->m_changed[r1] || this->m_changed[r2])
+                    this->m_pairMoves[pairIndex(r1, r2)] = SwapStarMove{ -epsilon, -1, -1, 0, 0 };
+
+        // Cheapest way to insert `customer` into the route of `removed` once `removed` leaves it:
+        // either in its place or at one of the three best positions of the route.
+        auto bestInsertion = [&](int customer, int removed, int &after)
+        {
+            int r = this->m_routeOf[removed];
+            int p = this->m_positionOf[removed];
+            int prev = pred(removed), next = succ(removed);
+
+            double cost = d(prev, customer) + d(customer, next) - d(prev, next);
+            after = p;
+
+            const std::vector<int> &route = this->m_routes[r];
+            const ThreeBestInsert &top = this->m_insertions.Get(this->m_versions[r], route.data(),
+                                                                static_cast<int>(route.size()), *this->m_distances, customer);
+            for (const InsertPosition &position : top.best)
+            {
+                // Positions next to the removed customer are no longer valid.
+                if (position.after == p - 1 || position.after == p)
+                    continue;
+
+                if (position.cost < cost)
+                {
+                    cost = position.cost;
+                    after = position.after;
+                }
+                break;
+            }
+
+            return cost;
+        };
+
+        auto evaluate = [&](int u, int v)
+        {
+            int ru = this->m_routeOf[u], rv = this->m_routeOf[v];
+
+            if (this->m_loads[ru] - demand(u) + demand(v) > this->m_capacity ||
+                this->m_loads[rv] - demand(v) + demand(u) > this->m_capacity)
+                return;
+
+            int afterU, afterV;
+            double delta = d(pred(u), succ(u)) - d(pred(u), u) - d(u, succ(u))
+                           + d(pred(v), succ(v)) - d(pred(v), v) - d(v, succ(v))
+                           + bestInsertion(u, v, afterU) + bestInsertion(v, u, afterV);
+
+            SwapStarMove &best = this->m_pairMoves[pairIndex(ru, rv)];
+            if (delta < best.delta)
+                best = SwapStarMove{ delta, u, v, afterU, afterV };
+        };
+
+        if (neighbors.k() > 0)
+        {
+            // Granular SWAP*: only customers u, v in different routes with v among the k nearest of u.
+            int customers = static_cast<int>(this->m_routeOf.size()) - 1;
+
+            for (int u = 1; u <= customers; ++u)
+            {
+                const int *candidates = neighbors.of(u);
+                int ru = this->m_routeOf[u];
+
+                for (int c = 0; c < neighbors.k(); ++c)
+                {
+                    int rv = this->m_routeOf[candidates[c]];
+                    if (rv != ru && (this->m_changed[ru] || this->m_changed[rv]))
+                        evaluate(u, candidates[c]);
+                }
+            }
+        }
+        else
+        {
+            for (int r2 = 1; r2 < routes; ++r2)
+                for (int r1 = 0; r1 < r2; ++r1)
+                    if (this->m_changed[r1] || this->m_changed[r2])
+                        for (int u : this->m_routes[r1])
+                            for (int v : this->m_routes[r2])
+                                evaluate(u, v);
+        }
+
+        std::fill(this->m_changed.begin(), this->m_changed.end(), 0);
+
+        const SwapStarMove *move = nullptr;
+        for (const SwapStarMove &candidate : this->m_pairMoves)
+            if (candidate.u >= 0 && (move == nullptr || candidate.delta < move->delta))
+                move = &candidate;
+
+        if (move == nullptr)
+            return false;
+
+        int u = move->u, v = move->v;
+        int ru = this->m_routeOf[u], rv = this->m_routeOf[v];
+
+        Rewrite(ru, this->m_positionOf[u], v, move->afterV);
+        Rewrite(rv, this->m_positionOf[v], u, move->afterU);
+
+        this->m_loads[ru] += demand(v) - demand(u);
+        this->m_loads[rv] += demand(u) - demand(v);
+        this->m_versions[ru] = ++this->m_nextVersion;
+        this->m_versions[rv] = ++this->m_nextVersion;
+        this->m_changed[ru] = this->m_changed[rv] = 1;
+        Renumber(ru, 0);
+        Renumber(rv, 0);
+
+        this->m_cost += move->delta;
+        return true;
+    }
+
+    void Annealing::Rewrite(int route, int removed, int inserted, int after)
+    {
+        const std::vector<int> &customers = this->m_routes[route];
+        this->m_buffer.clear();
+
+        if (after == -1)
+            this->m_buffer.push_back(inserted);
+
+        for (int p = 0; p < static_cast<int>(customers.size()); ++p)
+        {
+            if (p == removed)
+            {
+                if (after == removed)
+                    this->m_buffer.push_back(inserted);
+                continue;
+            }
+
+            this->m_buffer.push_back(customers[p]);
+
+            if (p == after)
+                this->m_buffer.push_back(inserted);
+        }
+
+        this->m_routes[route].swap(this->m_buffer);
+    }
+
+    void Annealing::Renumber(int route, int from)
+    {
+        const std::vector<int> &customers = this->m_routes[route];
+
+        for (int p = from; p < static_cast<int>(customers.size()); ++p)
+        {
+            this->m_routeOf[customers[p]] = route;
+            this->m_positionOf[customers[p]] = p;
+        }
+    }
+}
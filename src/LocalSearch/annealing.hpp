@@ -0,0 +1,182 @@
+#ifndef ANNEALING_H
+#define ANNEALING_H
+
+#include <utility>
+#include <vector>
+#include "node.hpp"
+#include "distance_matrix.hpp"
+#include "neighbor_lists.hpp"
+#include "insertion_cache.hpp"
+#include "../Core/chromosome.hpp"
+
+namespace LS
+{
+    /**
+     * @brief Cooling schedule of a simulated annealing run.
+     */
+    struct AnnealingSchedule
+    {
+        double temperature = 10;
+        double cooling = 0.95;
+        double minTemperature = 0.1;
+        int steps = 0;   // Moves tried per temperature; 0 uses the number of customers.
+        int swapStar = 0;   // Improving SWAP* steps applied to the best state; 0 skips the descent.
+    };
+
+    /**
+     * @brief Simulated annealing on an in-place route state with delta evaluation.
+     *
+     * The routes of the chromosome are loaded once. A step draws a random move (relocate, swap
+     * or 2-opt reversal) between a customer and one of its neighbors, computes its cost delta
+     * and its capacity feasibility in O(1) from the route state, and only changes the routes if
+     * the Metropolis criterion accepts it. Applying a move costs O(route length).
+     *
+     * Accepted moves are kept in an undo log that is cleared whenever a new best state is
+     * reached. At the end the log is undone, which brings the routes back to the best state
+     * without ever copying it.
+     *
+     * The best state can then be refined by a SWAP* descent on the same route state: moves are
+     * priced from the three best insertion positions of the customers in the routes, the best
+     * one of each pair of routes is kept, and each step applies the best improving one by
+     * rewriting its two routes. The next step only prices again the pairs of those two routes.
+     */
+    class Annealing
+    {
+    public:
+        Annealing() : m_nodes(nullptr), m_distances(nullptr), m_capacity(0), m_cost(0), m_nextVersion(0) {}
+
+        /**
+         * @brief Anneals the routes of a chromosome and writes the best state back to its DNA.
+         *
+         * The chromosome must have its routes computed (CalculateFitness); it is evaluated again
+         * at the end.
+         *
+         * @param chromosome Chromosome to improve.
+         * @param nodes
+         * @param distances
+         * @param neighbors Candidate lists; an empty list draws candidates among every customer.
+         * @param capacity
+         * @param schedule
+         *
+         * @return The number of accepted moves.
+         */
+        int Run(GA::Chromosome &chromosome, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                const NeighborLists &neighbors, int capacity, const AnnealingSchedule &schedule);
+
+    private:
+        enum class MoveType { Relocate, Swap, Reverse };
+
+        /**
+         * @brief An applied move, with what is needed to revert it.
+         *
+         * Relocate: customer `u` left position `position` of route `route`.
+         * Swap: customers `u` and `v` exchanged their places.
+         * Reverse: positions `position`..`end` of route `route` were reversed.
+         */
+        struct Move
+        {
+            MoveType type;
+            int u;
+            int v;
+            int route;
+            int position;
+            int end;
+        };
+
+        const std::vector<Node> *m_nodes;
+        const DistanceMatrix *m_distances;
+        double m_capacity;
+        double m_cost;
+
+        std::vector<std::vector<int>> m_routes;
+        std::vector<double> m_loads;
+        std::vector<int> m_routeOf;
+        std::vector<int> m_positionOf;
+        std::vector<Move> m_undo;
+
+        /**
+         * @brief A SWAP* move: u and v exchange routes, u going after position `afterU` of the
+         * route of v and v after position `afterV` of the route of u.
+         */
+        struct SwapStarMove
+        {
+            double delta;
+            int u;
+            int v;
+            int afterU;
+            int afterV;
+        };
+
+        // Routes are identified by a version in the insertion cache; a rewritten route gets a new one.
+        InsertionCache m_insertions;
+        std::vector<uint64_t> m_versions;
+        uint64_t m_nextVersion;
+        std::vector<int> m_buffer;
+
+        // Best move of each pair of routes, and the routes changed since their pairs were priced.
+        std::vector<SwapStarMove> m_pairMoves;
+        std::vector<char> m_changed;
+
+        void Load(const GA::Chromosome &chromosome);
+        void Export(GA::Chromosome &chromosome) const;
+
+        /**
+         * @brief Draws a move between u and v and applies it if accepted.
+         *
+         * @return true if a move was applied.
+         */
+        bool TryMove(int u, int v, double temperature);
+
+        bool Accept(double delta, double temperature) const;
+
+        // Moves are applied in place; Relocate inserts u at `position` of route `to`.
+        void Relocate(int u, int to, int position);
+        void Swap(int u, int v);
+        void Reverse(int route, int first, int last);
+
+        void Undo(const Move &move);
+
+        /**
+         * @brief Applies the best improving SWAP* move, if any.
+         *
+         * Only the pairs of routes flagged in m_changed are priced; the flags are cleared.
+         *
+         * @param neighbors Candidate lists; an empty list prices every pair of customers in
+         * different routes.
+         *
+         * @return true if a move was applied.
+         */
+        bool SwapStar(const NeighborLists &neighbors);
+
+        /**
+         * @brief Removes the customer at `removed` from a route and inserts `inserted` after
+         * position `after` (-1 for the depot, `removed` for the freed place).
+         */
+        void Rewrite(int route, int removed, int inserted, int after);
+
+        /**
+         * @brief Refreshes the position of the customers of a route from index `from` on.
+         */
+        void Renumber(int route, int from);
+
+        int pred(int u) const { int p = m_positionOf[u]; return p > 0 ? m_routes[m_routeOf[u]][p - 1] : 0; }
+        int succ(int u) const
+        {
+            const std::vector<int> &route = m_routes[m_routeOf[u]];
+            int p = m_positionOf[u];
+            return p + 1 < static_cast<int>(route.size()) ? route[p + 1] : 0;
+        }
+
+        static size_t pairIndex(int r1, int r2)
+        {
+            if (r1 > r2)
+                std::swap(r1, r2);
+            return static_cast<size_t>(r2) * (r2 - 1) / 2 + r1;
+        }
+
+        double d(int a, int b) const { return (*m_distances)(a, b); }
+        double demand(int x) const { return (*m_nodes)[x].getDemand(); }
+    };
+}
+
+#endif
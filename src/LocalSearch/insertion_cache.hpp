@@ -0,0 +1,143 @@
+#ifndef INSERTION_CACHE_H
+#define INSERTION_CACHE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "distance_matrix.hpp"
+
+namespace LS
+{
+    /**
+     * @brief An insertion position of a customer in a route.
+     *
+     * `after` is the index of the predecessor within the route, or -1 when the customer is
+     * inserted right after the depot.
+     */
+    struct InsertPosition
+    {
+        double cost;
+        int after;
+    };
+
+    /**
+     * @brief The three cheapest insertion positions of a customer in a route.
+     *
+     * Three positions are enough for SWAP*: removing a customer from the route invalidates at
+     * most two of them.
+     */
+    struct ThreeBestInsert
+    {
+        uint64_t signature = 0;
+        int customer = -1;
+        InsertPosition best[3];
+
+        inline void reset()
+        {
+            for (auto &position : best)
+                position = InsertPosition{ std::numeric_limits<double>::max(), -2 };
+        }
+
+        inline void add(double cost, int after)
+        {
+            if (cost >= best[2].cost)
+                return;
+
+            if (cost >= best[1].cost)
+                best[2] = InsertPosition{ cost, after };
+            else if (cost >= best[0].cost)
+            {
+                best[2] = best[1];
+                best[1] = InsertPosition{ cost, after };
+            }
+            else
+            {
+                best[2] = best[1];
+                best[1] = best[0];
+                best[0] = InsertPosition{ cost, after };
+            }
+        }
+    };
+
+    /**
+     * @brief Bounded cache of the three best insertion positions per (route, customer).
+     *
+     * Each route is identified by a signature given by the caller, which must change whenever
+     * the route does, and entries are keyed by the signature and the customer, so routes left
+     * untouched by a move keep their entries across successive SWAP* steps. The table is
+     * direct-mapped and sized for the pairs SWAP* can query, up to MAX_ENTRIES: a new entry
+     * replaces the one in its slot, so the memory stays bounded on large instances.
+     */
+    class InsertionCache
+    {
+    public:
+        InsertionCache() : m_mask(0) {}
+
+        /**
+         * @brief Sizes the cache for a solution.
+         *
+         * @param customers Number of customers.
+         * @param routes Number of routes.
+         * @param candidates Number of routes a customer can be queried for: the size of the
+         * neighbor lists, or 0 when every route can be.
+         */
+        inline void Prepare(size_t customers, size_t routes, size_t candidates)
+        {
+            size_t pairs = customers * (candidates > 0 ? std::min(candidates, routes) : routes);
+            size_t size = 1;
+            while (size < 2 * pairs && size < MAX_ENTRIES)
+                size <<= 1;
+
+            // Solutions of an instance vary little in size; the table only shrinks when it is
+            // four times larger than needed, so it is not rebuilt (and emptied) at every call.
+            if (size > this->m_entries.size() || size * 4 <= this->m_entries.size())
+            {
+                this->m_entries.assign(size, ThreeBestInsert());
+                this->m_mask = size - 1;
+            }
+        }
+
+        /**
+         * @brief Three best positions to insert a customer in a route.
+         *
+         * @param signature Signature of the route; never 0.
+         * @param customers Customers of the route, in order.
+         * @param size Number of customers of the route.
+         * @param distances
+         * @param customer Customer to insert.
+         */
+        inline const ThreeBestInsert &Get(uint64_t signature, const int *customers, int size,
+                                          const DistanceMatrix &distances, int customer)
+        {
+            uint64_t key = (signature ^ static_cast<uint64_t>(customer)) * 0x9e3779b97f4a7c15ULL;
+            ThreeBestInsert &entry = this->m_entries[(key >> 32) & this->m_mask];
+
+            if (entry.signature == signature && entry.customer == customer)
+                return entry;
+
+            entry.reset();
+            entry.signature = signature;
+            entry.customer = customer;
+
+            for (int after = -1; after < size; ++after)
+            {
+                int pred = (after < 0) ? 0 : customers[after];
+                int succ = (after + 1 < size) ? customers[after + 1] : 0;
+
+                entry.add(distances(pred, customer) + distances(customer, succ) - distances(pred, succ), after);
+            }
+
+            return entry;
+        }
+
+    private:
+        // 2^18 entries of 64 bytes: 16 MB per thread at most.
+        static constexpr size_t MAX_ENTRIES = size_t(1) << 18;
+
+        size_t m_mask;
+        std::vector<ThreeBestInsert> m_entries;
+    };
+}
+
+#endif
@@ -0,0 +1,382 @@
+#include "local_search.hpp"
+#include "utils.hpp"
+#include <numeric>
+
+namespace LS
+{
+    namespace
+    {
+        const double EPSILON = 1e-6;
+    }
+
+    int LocalSearch::Run(GA::Chromosome &chromosome, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                         const NeighborLists &neighbors, int capacity)
+    {
+        this->m_nodes = &nodes;
+        this->m_distances = &distances;
+        this->m_neighbors = &neighbors;
+        this->m_capacity = capacity;
+
+        Load(chromosome);
+
+        this->m_dontLook.assign(this->m_customers + 1, 0);
+
+        this->m_order.resize(this->m_customers);
+        std::iota(this->m_order.begin(), this->m_order.end(), 1);
+        for (int i = this->m_customers - 1; i > 0; --i)
+            std::swap(this->m_order[i], this->m_order[utils::randInteger(0, i)]);
+
+        int moves = 0;
+        bool improved = true;
+
+        while (improved)
+        {
+            improved = false;
+
+            for (int u : this->m_order)
+            {
+                if (this->m_dontLook[u])
+                    continue;
+
+                if (ImproveCustomer(u))
+                {
+                    moves++;
+                    improved = true;
+                }
+                else
+                    this->m_dontLook[u] = 1;
+            }
+        }
+
+        Export(chromosome);
+        return moves;
+    }
+
+    void LocalSearch::Load(const GA::Chromosome &chromosome)
+    {
+        const std::vector<GA::Route> &routes = chromosome.getRoutes();
+        const std::vector<gene_t> &dna = chromosome.getDNA();
+
+        // Customers keep their node index; each route adds a start and an end depot after them.
+        this->m_customers = static_cast<int>(dna.size());
+        this->m_list.resize(this->m_customers + 1 + 2 * routes.size());
+        this->m_routes.resize(routes.size());
+
+        for (int x = 0; x <= this->m_customers; ++x)
+            this->m_list[x].location = x;
+
+        for (size_t r = 0; r < routes.size(); ++r)
+        {
+            int start = this->m_customers + 1 + 2 * static_cast<int>(r);
+            int end = start + 1;
+
+            this->m_list[start].location = 0;
+            this->m_list[end].location = 0;
+            this->m_routes[r].start = start;
+
+            int prev = start;
+            for (size_t pos = routes[r].begin; pos < routes[r].end; ++pos)
+            {
+                int x = dna[pos];
+                this->m_list[prev].next = x;
+                this->m_list[x].prev = prev;
+                prev = x;
+            }
+            this->m_list[prev].next = end;
+            this->m_list[end].prev = prev;
+            this->m_list[start].prev = -1;
+            this->m_list[end].next = -1;
+
+            UpdateRoute(static_cast<int>(r));
+        }
+    }
+
+    void LocalSearch::Export(GA::Chromosome &chromosome) const
+    {
+        thread_local std::vector<gene_t> dna;
+        dna.clear();
+
+        for (const LSRoute &route : this->m_routes)
+            for (int x = this->m_list[route.start].next; !isDepot(x); x = this->m_list[x].next)
+                dna.push_back(static_cast<gene_t>(x));
+
+        chromosome.setDNA(dna);
+    }
+
+    void LocalSearch::UpdateRoute(int r)
+    {
+        LSRoute &route = this->m_routes[r];
+        LSNode &start = this->m_list[route.start];
+
+        start.route = r;
+        start.position = 0;
+        start.load = 0;
+        start.dist = 0;
+
+        int prev = route.start;
+        int x = start.next;
+
+        while (true)
+        {
+            LSNode &node = this->m_list[x];
+            const LSNode &before = this->m_list[prev];
+
+            node.route = r;
+            node.position = before.position + 1;
+            node.load = before.load + (isDepot(x) ? 0 : demand(x));
+            node.dist = before.dist + d(prev, x);
+
+            if (isDepot(x))
+                break;
+
+            prev = x;
+            x = node.next;
+        }
+
+        route.end = x;
+        route.load = this->m_list[x].load;
+        route.cost = this->m_list[x].dist;
+    }
+
+    bool LocalSearch::ImproveCustomer(int u)
+    {
+        const int *candidates;
+        int count;
+
+        if (this->m_neighbors->k() > 0)
+        {
+            candidates = this->m_neighbors->of(u);
+            count = this->m_neighbors->k();
+        }
+        else
+        {
+            this->m_candidates.resize(this->m_customers);
+            std::iota(this->m_candidates.begin(), this->m_candidates.end(), 1);
+            candidates = this->m_candidates.data();
+            count = this->m_customers;
+        }
+
+        for (int c = 0; c < count; ++c)
+        {
+            int v = candidates[c];
+            if (v == u)
+                continue;
+
+            for (int length = 1; length <= 3; ++length)
+                if (Relocate(u, v, length) || Relocate(u, this->m_list[v].prev, length))
+                    return true;
+
+            if (Swap(u, v))
+                return true;
+
+            if (this->m_list[u].route == this->m_list[v].route)
+            {
+                if (TwoOpt(u, v))
+                    return true;
+            }
+            else if (TwoOptStar(u, this->m_list[v].prev) || TwoOptStar(this->m_list[u].prev, v))
+                return true;
+        }
+
+        return false;
+    }
+
+    bool LocalSearch::Relocate(int u, int v, int length)
+    {
+        // The chain u..x has `length` customers.
+        int x = u;
+        for (int i = 1; i < length; ++i)
+        {
+            x = this->m_list[x].next;
+            if (isDepot(x))
+                return false;
+        }
+
+        const LSNode &nu = this->m_list[u];
+        const LSNode &nx = this->m_list[x];
+        const LSNode &nv = this->m_list[v];
+
+        if (v == nu.prev || v == x)
+            return false;
+
+        bool sameRoute = nu.route == nv.route;
+        if (sameRoute && nv.position >= nu.position && nv.position <= nx.position)
+            return false;
+
+        int p = nu.prev;
+        int n = nx.next;
+        int w = nv.next;
+
+        double chainLoad = nx.load - this->m_list[p].load;
+        if (!sameRoute && this->m_routes[nv.route].load + chainLoad > this->m_capacity)
+            return false;
+
+        double delta = d(p, n) - d(p, u) - d(x, n) + d(v, u) + d(x, w) - d(v, w);
+        if (delta > -EPSILON)
+            return false;
+
+        int from = nu.route;
+        int to = nv.route;
+
+        MoveChain(u, x, v);
+
+        UpdateRoute(from);
+        if (to != from)
+            UpdateRoute(to);
+
+        Wake(p);
+        Wake(n);
+        Wake(u);
+        Wake(x);
+        Wake(v);
+        return true;
+    }
+
+    bool LocalSearch::Swap(int u, int v)
+    {
+        const LSNode &nu = this->m_list[u];
+        const LSNode &nv = this->m_list[v];
+
+        if (nu.next == v || nv.next == u)
+            return false;
+
+        bool sameRoute = nu.route == nv.route;
+        double du = demand(u);
+        double dv = demand(v);
+
+        if (!sameRoute && (this->m_routes[nu.route].load - du + dv > this->m_capacity ||
+                           this->m_routes[nv.route].load - dv + du > this->m_capacity))
+            return false;
+
+        int pu = nu.prev, su = nu.next;
+        int pv = nv.prev, sv = nv.next;
+
+        double delta = d(pu, v) + d(v, su) + d(pv, u) + d(u, sv)
+                     - d(pu, u) - d(u, su) - d(pv, v) - d(v, sv);
+        if (delta > -EPSILON)
+            return false;
+
+        int ru = nu.route;
+        int rv = nv.route;
+
+        this->m_list[pu].next = v;
+        this->m_list[su].prev = v;
+        this->m_list[pv].next = u;
+        this->m_list[sv].prev = u;
+        this->m_list[u].prev = pv;
+        this->m_list[u].next = sv;
+        this->m_list[v].prev = pu;
+        this->m_list[v].next = su;
+
+        UpdateRoute(ru);
+        if (rv != ru)
+            UpdateRoute(rv);
+
+        Wake(u);
+        Wake(v);
+        return true;
+    }
+
+    bool LocalSearch::TwoOpt(int u, int v)
+    {
+        if (this->m_list[v].position < this->m_list[u].position)
+            std::swap(u, v);
+
+        int su = this->m_list[u].next;
+        int sv = this->m_list[v].next;
+
+        if (su == v)
+            return false;
+
+        // Reversing su..v replaces the edges (u, su) and (v, sv) by (u, v) and (su, sv).
+        double delta = d(u, v) + d(su, sv) - d(u, su) - d(v, sv);
+        if (delta > -EPSILON)
+            return false;
+
+        int x = su;
+        while (x != sv)
+        {
+            int next = this->m_list[x].next;
+            std::swap(this->m_list[x].prev, this->m_list[x].next);
+            x = next;
+        }
+
+        this->m_list[u].next = v;
+        this->m_list[v].prev = u;
+        this->m_list[su].next = sv;
+        this->m_list[sv].prev = su;
+
+        UpdateRoute(this->m_list[u].route);
+
+        Wake(u);
+        Wake(v);
+        Wake(su);
+        Wake(sv);
+        return true;
+    }
+
+    bool LocalSearch::TwoOptStar(int u, int v)
+    {
+        const LSNode &nu = this->m_list[u];
+        const LSNode &nv = this->m_list[v];
+
+        if (nu.route == nv.route || nu.next < 0 || nv.next < 0)
+            return false;
+
+        const LSRoute &ru = this->m_routes[nu.route];
+        const LSRoute &rv = this->m_routes[nv.route];
+
+        // Route of u keeps its head and takes the tail of v, and the other way around.
+        if (nu.load + (rv.load - nv.load) > this->m_capacity ||
+            nv.load + (ru.load - nu.load) > this->m_capacity)
+            return false;
+
+        int su = nu.next;
+        int sv = nv.next;
+
+        double delta = d(u, sv) + d(v, su) - d(u, su) - d(v, sv);
+        if (delta > -EPSILON)
+            return false;
+
+        int routeU = nu.route;
+        int routeV = nv.route;
+
+        this->m_list[u].next = sv;
+        this->m_list[sv].prev = u;
+        this->m_list[v].next = su;
+        this->m_list[su].prev = v;
+
+        UpdateRoute(routeU);
+        UpdateRoute(routeV);
+
+        Wake(u);
+        Wake(v);
+        Wake(su);
+        Wake(sv);
+        return true;
+    }
+
+    void LocalSearch::MoveChain(int first, int last, int after)
+    {
+        int p = this->m_list[first].prev;
+        int n = this->m_list[last].next;
+        this->m_list[p].next = n;
+        this->m_list[n].prev = p;
+
+        int w = this->m_list[after].next;
+        this->m_list[after].next = first;
+        this->m_list[first].prev = after;
+        this->m_list[last].next = w;
+        this->m_list[w].prev = last;
+    }
+
+    void LocalSearch::Wake(int x)
+    {
+        if (x < 0)
+            return;
+
+        for (int y : { this->m_list[x].prev, x, this->m_list[x].next })
+            if (y > 0 && !isDepot(y))
+                this->m_dontLook[y] = 0;
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef LOCAL_SEARCH_H
+#define LOCAL_SEARCH_H
+
+#include <vector>
+#include "node.hpp"
+#include "distance_matrix.hpp"
+#include "neighbor_lists.hpp"
+#include "../Core/chromosome.hpp"
+
+namespace LS
+{
+    /**
+     * @brief Classical local search over the routes of a chromosome.
+     *
+     * Routes are kept as doubly linked lists with per-node prefix data (position, load and
+     * distance from the start depot), refreshed only for the routes a move changes. Moves are
+     * evaluated in O(1) from that data:
+     *
+     * - relocate of one customer and or-opt of a chain of two or three customers;
+     * - swap of two customers;
+     * - 2-opt inside a route;
+     * - 2-opt* (tail exchange) between two routes.
+     *
+     * Each customer is only paired with the customers in its neighbor list. The search uses
+     * first improvement and don't-look bits: a customer is skipped until a move touches it or
+     * one of its neighbors in a route.
+     */
+    class LocalSearch
+    {
+    public:
+        LocalSearch() : m_nodes(nullptr), m_distances(nullptr), m_neighbors(nullptr), m_capacity(0), m_customers(0) {}
+
+        /**
+         * @brief Runs the local search on a chromosome and writes the improved routes back to its DNA.
+         *
+         * The chromosome must have its routes computed (CalculateFitness). Its fitness is not updated.
+         *
+         * @param chromosome Chromosome to improve.
+         * @param nodes
+         * @param distances
+         * @param neighbors Candidate lists; an empty list makes every customer a candidate.
+         * @param capacity
+         *
+         * @return The number of moves applied.
+         */
+        int Run(GA::Chromosome &chromosome, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                const NeighborLists &neighbors, int capacity);
+
+    private:
+        struct LSNode
+        {
+            int location;   // Node of the instance (0 for the depots).
+            int prev;
+            int next;
+            int route;
+            int position;   // Index in the route, the start depot is 0.
+            double load;    // Load from the start depot up to this node.
+            double dist;    // Distance from the start depot up to this node.
+        };
+
+        struct LSRoute
+        {
+            int start;
+            int end;
+            double load;
+            double cost;
+        };
+
+        const std::vector<Node> *m_nodes;
+        const DistanceMatrix *m_distances;
+        const NeighborLists *m_neighbors;
+        double m_capacity;
+        int m_customers;
+
+        std::vector<LSNode> m_list;
+        std::vector<LSRoute> m_routes;
+        std::vector<char> m_dontLook;
+        std::vector<int> m_order;
+        std::vector<int> m_candidates;
+
+        void Load(const GA::Chromosome &chromosome);
+        void Export(GA::Chromosome &chromosome) const;
+
+        /**
+         * @brief Refreshes the prefix data of a route after it changed.
+         */
+        void UpdateRoute(int r);
+
+        /**
+         * @brief Tries every move between a customer and its candidates, applying the first improving one.
+         *
+         * @return true if a move was applied.
+         */
+        bool ImproveCustomer(int u);
+
+        bool Relocate(int u, int v, int length);
+        bool Swap(int u, int v);
+        bool TwoOpt(int u, int v);
+        bool TwoOptStar(int u, int v);
+
+        /**
+         * @brief Moves the chain first..last (in route order) right after node `after`.
+         */
+        void MoveChain(int first, int last, int after);
+
+        /**
+         * @brief Clears the don't-look bits of a node and its route neighbors.
+         */
+        void Wake(int x);
+
+        double d(int a, int b) const { return (*m_distances)(m_list[a].location, m_list[b].location); }
+        double demand(int x) const { return (*m_nodes)[m_list[x].location].getDemand(); }
+        bool isDepot(int x) const { return x > m_customers; }
+    };
+}
+
+#endif
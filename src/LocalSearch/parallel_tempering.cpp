@@ -0,0 +1,163 @@
+#include "parallel_tempering.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace LS
+{
+    int ParallelTempering::Run(GA::Chromosome &solution, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                               int capacity, const TemperingOptions &options, GA::TaskPool *pool)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+
+        this->m_nodes = &nodes;
+        this->m_distances = &distances;
+        this->m_capacity = capacity;
+        this->m_attempts = 0;
+        this->m_exchanges = 0;
+
+        int replicas = std::max(1, options.replicas);
+        this->m_replicas.resize(replicas);
+
+        for (int r = 0; r < replicas; ++r)
+        {
+            Replica &replica = this->m_replicas[r];
+            double ratio = replicas > 1 ? double(r) / (replicas - 1) : 0.0;
+
+            replica.temperature = options.minTemperature * std::pow(options.maxTemperature / options.minTemperature, ratio);
+            replica.current = solution;
+            replica.current.CalculateFitness(nodes, distances, capacity, replica.labels, 0);
+            replica.best = solution;
+        }
+
+        if (solution.getDNA().size() < 3)
+            return 0;
+
+        // Walks reseed from this key and exchanges draw from their own generator, so no decision
+        // depends on which thread ran which walk; the generator of the calling thread is restored
+        // afterwards.
+        utils::Xoshiro256 generator = utils::Rng();
+        uint64_t key = generator();
+        utils::Xoshiro256 exchanges(key ^ 0x9e3779b97f4a7c15ULL);
+        int round = 0;
+
+        auto walk = [this, &key, &round, &options, replicas](size_t r)
+        {
+            utils::Rng().Seed(key + (uint64_t(round) * replicas + r) * 0xd1b54a32d192ed03ULL);
+            Walk(this->m_replicas[r], options.steps);
+        };
+
+        double bestFitness = solution.getFitness();
+        int withoutImprovement = 0;
+
+        for (; round < options.rounds; ++round)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+            if (elapsed.count() > options.timeLimit || withoutImprovement >= options.stagnation)
+                break;
+
+            if (pool != nullptr)
+                pool->ParallelFor(replicas, walk);
+            else
+                for (int r = 0; r < replicas; ++r)
+                    walk(r);
+
+            // Exchanges between neighboring temperatures, even pairs on even rounds.
+            for (int r = round % 2; r + 1 < replicas; r += 2)
+            {
+                Replica &cold = this->m_replicas[r];
+                Replica &hot = this->m_replicas[r + 1];
+
+                double exponent = (cold.current.getFitness() - hot.current.getFitness()) *
+                                  (1.0 / cold.temperature - 1.0 / hot.temperature);
+
+                this->m_attempts++;
+                if (exponent >= 0 || (exchanges() >> 11) * 0x1.0p-53 < std::exp(exponent))
+                {
+                    std::swap(cold.current, hot.current);
+                    std::swap(cold.labels, hot.labels);
+                    this->m_exchanges++;
+                }
+            }
+
+            withoutImprovement++;
+            for (const Replica &replica : this->m_replicas)
+            {
+                if (replica.best.getFitness() < bestFitness)
+                {
+                    bestFitness = replica.best.getFitness();
+                    withoutImprovement = 0;
+                }
+            }
+        }
+
+        utils::Rng() = generator;
+
+        for (const Replica &replica : this->m_replicas)
+            if (replica.best.getFitness() < solution.getFitness())
+                solution = replica.best;
+
+        return round;
+    }
+
+    void ParallelTempering::Walk(Replica &replica, int steps)
+    {
+        for (int step = 0; step < steps; ++step)
+        {
+            replica.candidate = replica.current;
+            size_t first = Perturb(replica.candidate);
+
+            replica.candidateLabels.copyPrefix(replica.labels, first);
+            replica.candidate.CalculateFitness(*this->m_nodes, *this->m_distances, this->m_capacity,
+                                               replica.candidateLabels, first);
+
+            double delta = replica.candidate.getFitness() - replica.current.getFitness();
+
+            if (delta < 0 || utils::randDouble(0, 1) < std::exp(-delta / replica.temperature))
+            {
+                std::swap(replica.current, replica.candidate);
+                std::swap(replica.labels, replica.candidateLabels);
+
+                if (replica.current.getFitness() < replica.best.getFitness())
+                    replica.best = replica.current;
+            }
+        }
+    }
+
+    size_t ParallelTempering::Perturb(GA::Chromosome &candidate)
+    {
+        thread_local std::vector<gene_t> segment;
+
+        const std::vector<gene_t> &dna = candidate.getDNA();
+        int size = static_cast<int>(dna.size());
+
+        int i = utils::randInteger(0, size - 1);
+        int j = utils::randInteger(0, size - 2);
+        if (j >= i)
+            j++;
+
+        if (i > j)
+            std::swap(i, j);
+
+        switch (utils::randInteger(0, 2))
+        {
+        case 0:
+            candidate.swapGenes(i, j);
+            break;
+        case 1:
+            segment.assign(dna.begin() + i, dna.begin() + j + 1);
+            std::reverse(segment.begin(), segment.end());
+            candidate.setGenes(i, segment.data(), segment.size());
+            break;
+        default:
+            // The customer at i moves to position j, shifting the ones in between.
+            segment.assign(dna.begin() + i + 1, dna.begin() + j + 1);
+            segment.push_back(dna[i]);
+            candidate.setGenes(i, segment.data(), segment.size());
+            break;
+        }
+
+        return i;
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef PARALLEL_TEMPERING_H
+#define PARALLEL_TEMPERING_H
+
+#include <limits>
+#include <vector>
+#include "node.hpp"
+#include "distance_matrix.hpp"
+#include "../Core/chromosome.hpp"
+#include "../Core/task_pool.hpp"
+
+namespace LS
+{
+    /**
+     * @brief Settings of a parallel tempering run.
+     */
+    struct TemperingOptions
+    {
+        int replicas = 4;
+        double minTemperature = 0.1;
+        double maxTemperature = 10;
+        int rounds = 9;                 // Exchange rounds.
+        int steps = 10;                 // Metropolis steps of every replica per round.
+        int stagnation = std::numeric_limits<int>::max();   // Rounds without improvement before stopping.
+        double timeLimit = std::numeric_limits<double>::max();   // Seconds.
+    };
+
+    /**
+     * @brief Replica-exchange simulated annealing (parallel tempering).
+     *
+     * Several replicas of the solution walk at fixed temperatures, spaced geometrically between
+     * the minimum and maximum temperature. A step perturbs the giant tour of a replica (swap of
+     * two customers, reversal of a segment or relocation of a customer), evaluates it with
+     * Split, resumed from the first changed gene with the labels of the replica, and accepts it
+     * with the Metropolis criterion. After every round of steps, replicas
+     * at neighboring temperatures try to exchange their states, with probability
+     * min(1, exp((E_i - E_j)(1/T_i - 1/T_j))); even and odd pairs alternate between rounds.
+     *
+     * With a task pool, the replicas of a round run concurrently. Every walk reseeds its
+     * generator and the exchanges draw from a generator of their own, so the run does not depend
+     * on the number of threads.
+     */
+    class ParallelTempering
+    {
+    public:
+        ParallelTempering() : m_nodes(nullptr), m_distances(nullptr), m_capacity(0), m_attempts(0), m_exchanges(0) {}
+
+        /**
+         * @brief Runs parallel tempering from a solution and keeps the best state found.
+         *
+         * @param solution Evaluated starting solution; receives the best solution found.
+         * @param nodes
+         * @param distances
+         * @param capacity
+         * @param options
+         * @param pool Pool that runs the replicas of a round in parallel, or nullptr to run them
+         * one after the other on the calling thread.
+         *
+         * @return The number of rounds run.
+         */
+        int Run(GA::Chromosome &solution, const std::vector<Node> &nodes, const DistanceMatrix &distances,
+                int capacity, const TemperingOptions &options, GA::TaskPool *pool = nullptr);
+
+        /**
+         * @brief Fraction of the exchanges attempted in the last run that were accepted.
+         */
+        double getExchangeRate() const { return this->m_attempts > 0 ? double(this->m_exchanges) / this->m_attempts : 0.0; }
+
+    private:
+        struct Replica
+        {
+            GA::Chromosome current;
+            GA::Chromosome candidate;
+            GA::Chromosome best;
+            GA::SplitLabels labels;            // Split labels of current.
+            GA::SplitLabels candidateLabels;
+            double temperature;
+        };
+
+        const std::vector<Node> *m_nodes;
+        const DistanceMatrix *m_distances;
+        int m_capacity;
+
+        std::vector<Replica> m_replicas;
+        size_t m_attempts;
+        size_t m_exchanges;
+
+        /**
+         * @brief Runs the Metropolis steps of one replica in a round.
+         */
+        void Walk(Replica &replica, int steps);
+
+        /**
+         * @brief Applies a random perturbation of the giant tour to the candidate.
+         *
+         * @return The position of the first changed gene.
+         */
+        size_t Perturb(GA::Chromosome &candidate);
+    };
+}
+
+#endif
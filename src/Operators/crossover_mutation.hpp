@@ -3,61 +3,66 @@
 
 #include "../Core/chromosome.hpp"
 #include "../Core/population.hpp"
-#include <unordered_set>
-#include <omp.h>
 
 namespace {
 
     /**
      * @brief Auxiliar method to create child.
      *
+     * The DNA is built in thread-local buffers and copied into the child, which reuses the
+     * capacity of its previous DNA.
+     *
      * @param parent1 The first parent.
      * @param parent2 The second parent.
      * @param start Start index for copy DNA.
      * @param end End index for copy DNA.
-     *
-     * @return The resulting child of crossover.
+     * @param child The resulting child of crossover.
      */
-    inline GA::Chromosome
-    CreateChild(const std::vector<int> &parent1, const std::vector<int> &parent2, int start, int end)
+    inline void
+    CreateChild(const std::vector<gene_t> &parent1, const std::vector<gene_t> &parent2, int start, int end, GA::Chromosome &child)
     {
-        std::vector<int> dna(parent1.size(), -1);
-        std::unordered_set<int> genesInChild;
+        thread_local std::vector<gene_t> dna;
+        thread_local std::vector<char> genesInChild;
+
+        // The depot (0) is never a gene, so it marks the empty positions.
+        dna.assign(parent1.size(), 0);
+        genesInChild.assign(parent1.size() + 1, 0);
+        size_t inChild = 0;
 
         for (int i = start; i <= end; ++i)
         {
             dna[i] = parent1[i];
-            genesInChild.insert(parent1[i]);
+            genesInChild[parent1[i]] = 1;
+            inChild++;
         }
 
         size_t current = end + 1;
         size_t parentIndex = end + 1;
 
-        while (genesInChild.size() < dna.size())
+        while (inChild < dna.size())
         {
             if (parentIndex >= parent2.size())
                 parentIndex = 0;
 
-            int gene = parent2[parentIndex];
+            gene_t gene = parent2[parentIndex];
 
-            if (genesInChild.find(gene) == genesInChild.end())
+            if (!genesInChild[gene])
             {
                 if (current >= dna.size())
                     current = 0;
 
-                if (dna[current] == -1)
+                if (dna[current] == 0)
                 {
                     dna[current] = gene;
-                    genesInChild.insert(gene);
+                    genesInChild[gene] = 1;
+                    inChild++;
                     current++;
                 }
             }
             parentIndex++;
         }
-        
-        GA::Chromosome child;
+
         child.setDNA(dna);
-        return child;
     }
 
     /**
@@ -65,119 +70,92 @@ namespace {
      *
      * @param parent1 The first parent.
      * @param parent2 The second parent.
-     * @param population
-     *
-     * @return The resulting children of crossover.
+     * @param child1 The first resulting child of crossover.
+     * @param child2 The second resulting child of crossover.
      */
-    inline std::vector<GA::Chromosome>
-    CrossoverOX(GA::Chromosome &parent1, GA::Chromosome &parent2, GA::Population& population)
+    inline void
+    CrossoverOX(const GA::Chromosome &parent1, const GA::Chromosome &parent2, GA::Chromosome &child1, GA::Chromosome &child2)
     {
-        std::vector<int> cleanParent1Dna = parent1.getDNA();
-        std::vector<int> cleanParent2Dna = parent2.getDNA();
+        const std::vector<gene_t> &cleanParent1Dna = parent1.getDNA();
+        const std::vector<gene_t> &cleanParent2Dna = parent2.getDNA();
 
         int p1 = utils::randInteger(1, cleanParent1Dna.size() - 3);
         int p2 = utils::randInteger(p1 + 1, cleanParent2Dna.size() - 2);
 
-        GA::Chromosome child1 = CreateChild(cleanParent1Dna, cleanParent2Dna, p1, p2);
-        GA::Chromosome child2 = CreateChild(cleanParent2Dna, cleanParent1Dna, p1, p2);
-
-        std::vector<GA::Chromosome> children;
-        if (!population.contains(child1))
-            children.push_back(child1);
-
-        if (!population.contains(child2))
-            children.push_back(child2);
-
-        return children;
+        CreateChild(cleanParent1Dna, cleanParent2Dna, p1, p2, child1);
+        CreateChild(cleanParent2Dna, cleanParent1Dna, p1, p2, child2);
     }
 
     /**
-     * @brief Performs the Swap Mutation in each gene.
+     * @brief Performs the Swap Mutation in each gene of a child.
+     *
+     * Swaps are logged so a mutation that produces a duplicate can be undone without
+     * keeping a copy of the original DNA.
      *
      * @param population
-     * @param children Vector of child.
+     * @param child Child to mutate.
      */
-    void
-    SwapMutation(GA::Population& population, std::vector<GA::Chromosome> &children)
+    inline void
+    SwapMutation(const GA::Population& population, GA::Chromosome &child)
     {
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (size_t i = 0; i < children.size(); ++i)
-        {
-            bool mutated = false;
-            std::vector<int> originalDNA = children[i].getDNA();
+        thread_local std::vector<std::pair<size_t, size_t>> swaps;
+        swaps.clear();
 
-            for (size_t j = 1; j < children[i].getDNA().size() - 1; ++j)
+        size_t size = child.getDNA().size();
+
+        for (size_t j = 1; j < size - 1; ++j)
+        {
+            if (utils::randDouble(0, 1) < 0.05)
             {
-                if (utils::randDouble(0, 1) < 0.05)
-                {
-                    size_t n1;
+                size_t n1;
 
-                    do
-                    {
-                        n1 = utils::randInteger(1, children[i].getDNA().size() - 2);
-                    } while (n1 == j);
+                do
+                {
+                    n1 = utils::randInteger(1, size - 2);
+                } while (n1 == j);
 
-                    std::swap(children[i].getDNA()[j], children[i].getDNA()[n1]);
-                    mutated = true;
-                }
+                child.swapGenes(j, n1);
+                swaps.emplace_back(j, n1);
             }
-
-            if (mutated && population.contains(children[i]))
-                children[i].setDNA(originalDNA);
         }
+
+        if (!swaps.empty() && population.contains(child))
+            for (auto it = swaps.rbegin(); it != swaps.rend(); ++it)
+                child.swapGenes(it->first, it->second);
     }
 }
 
 namespace OP
 {
     /**
-     * @brief Performs Crossover and Mutation
+     * @brief Performs Crossover of two parents and Mutation of the resulting children.
      *
-     * @param parents Selected parents for crossover.
-     * @param population
+     * Only reads the population, so several pairs can be processed at the same time. A child
+     * already in the population after crossover is discarded.
      *
-     * @return The resulting children of crossover and mutation.
+     * @param parent1 The first parent.
+     * @param parent2 The second parent.
+     * @param population
+     * @param child1 The first resulting child.
+     * @param child2 The second resulting child.
+     * @param kept Receives, for each child, whether it was kept.
      */
-    inline 
-    std::vector<GA::Chromosome> CrossoverMutation(std::vector<GA::Chromosome>& parents, GA::Population& population)
+    inline void
+    CrossoverMutation(const GA::Chromosome& parent1, const GA::Chromosome& parent2, const GA::Population& population,
+                      GA::Chromosome& child1, GA::Chromosome& child2, char kept[2])
     {
-        std::vector<GA::Chromosome> children;
+        CrossoverOX(parent1, parent2, child1, child2);
 
-#ifdef _OPENMP
-        #pragma omp parallel
-#endif
-        {
-            std::vector<GA::Chromosome> local_children;
+        GA::Chromosome* children[2] = { &child1, &child2 };
 
-#ifdef _OPENMP
-            #pragma omp for nowait
-#endif            
-            for (size_t i = 0; i < parents.size(); i += 2)
-            {
-                std::vector<GA::Chromosome> newChildren = CrossoverOX(parents[i], parents[i + 1], population);
-                local_children.insert(local_children.end(), newChildren.begin(), newChildren.end());
-            }
-
-#ifdef _OPENMP
-            #pragma omp critical
-#endif          
-            children.insert(children.end(), local_children.begin(), local_children.end());
-        }
-
-        SwapMutation(population, children);
-
-#ifdef _OPENMP
-        #pragma omp parallel for
-#endif
-        for (size_t i = 0; i < children.size(); ++i)
+        for (int k = 0; k < 2; ++k)
         {
-            children[i].CalculateFitness(population.getNodes(), population.getCapacity());
-        }
+            kept[k] = !population.contains(*children[k]);
 
-        return children;
+            if (kept[k])
+                SwapMutation(population, *children[k]);
+        }
     }
 }
 
-#endif
\ No newline at end of file
+#endif
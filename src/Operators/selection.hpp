@@ -9,20 +9,21 @@ namespace {
     /**
      * @brief Tournament in a subset of the population (selected parents).
      *
-     * @param T Selected parents.
+     * @param individuals Individuals of the population.
+     * @param T Indices whose first k entries are the sampled subset.
      * @param k Size of the subset.
      *
-     * @return Winner chromosome (parent).
+     * @return Position in T of the winner chromosome (parent).
      */
-    static GA::Chromosome Tournament(std::vector<GA::Chromosome> &T, int k)
+    static int Tournament(const std::vector<GA::Chromosome> &individuals, const std::vector<int> &T, int k)
     {
-        GA::Chromosome bestFitness = T[0];
+        int best = 0;
 
         for (int i = 1; i < k; ++i)
-            if (T[i].getFitness() < bestFitness.getFitness())
-                bestFitness = T[i];
+            if (individuals[T[i]].getFitness() < individuals[T[best]].getFitness())
+                best = i;
 
-        return bestFitness;
+        return best;
     }
 }
 
@@ -31,42 +32,47 @@ namespace OP
     /**
      * @brief Parent Tournament for selecting parents to crossover.
      *
+     * Works on indices into the population, so no chromosome is copied. Each tournament
+     * samples its subset without replacement from the individuals not yet selected as parents.
+     *
      * @param population
      * @param parantSize Size of parents to pick up for crossover.
-     *
-     * @return Winners chromosomes (parents) for crossover.
+     * @param tournamentSize Size of each tournament (selection pressure). If 0, uses a third
+     * of the population plus two.
+     * @param parents Receives the indices of the winners chromosomes (parents) for crossover.
      */
-    inline std::vector<GA::Chromosome> TournamentSelection(GA::Population &population, int parentsSize)
+    inline void TournamentSelection(GA::Population &population, int parentsSize, int tournamentSize,
+                                    std::vector<int> &parents)
     {
-        std::vector<GA::Chromosome> aux_population = population.getIndividuals();
-        std::vector<GA::Chromosome> newIndividuals;
-        std::vector<GA::Chromosome> parents;
+        const std::vector<GA::Chromosome> &individuals = population.getIndividuals();
 
-        int subsetSize = (population.getIndividuals().size() / 3) + 2;
+        // Indices not selected yet live in available[0, remaining).
+        thread_local std::vector<int> available;
+        available.resize(individuals.size());
+        std::iota(available.begin(), available.end(), 0);
+        int remaining = static_cast<int>(available.size());
 
-        for (int i = 0; i < parentsSize; ++i)
-        {
-            newIndividuals.clear();
+        parents.clear();
 
-            std::vector<GA::Chromosome> temp_population = aux_population;
+        int subsetSize = tournamentSize > 0 ? tournamentSize : (individuals.size() / 3) + 2;
 
-            std::sample(aux_population.begin(), aux_population.end(),
-                        std::back_inserter(newIndividuals), subsetSize,
-                        std::mt19937{std::random_device{}()});
+        for (int i = 0; i < parentsSize && remaining > 0; ++i)
+        {
+            int k = std::min(subsetSize, remaining);
+
+            // Partial Fisher-Yates: the first k available indices become the sampled subset.
+            for (int j = 0; j < k; ++j)
+                std::swap(available[j], available[utils::randInteger(j, remaining - 1)]);
 
-            GA::Chromosome winner = Tournament(newIndividuals, subsetSize);
-            parents.push_back(winner);
+            int winner = Tournament(individuals, available, k);
+            parents.push_back(available[winner]);
 
-            auto it = std::find(aux_population.begin(), aux_population.end(), winner);
-            if (it != aux_population.end())
-                aux_population.erase(it);
+            std::swap(available[winner], available[--remaining]);
         }
 
         if (parents.size() % 2 != 0)
             parents.pop_back();
-
-        return parents;
     }
 }
 
-#endif
\ No newline at end of file
+#endif
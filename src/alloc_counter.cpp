@@ -0,0 +1,96 @@
+#include "alloc_counter.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<unsigned long long> allocations{0};
+
+    constexpr std::size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+}
+
+namespace utils {
+
+unsigned long long AllocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+}
+
+// Every form of operator new and delete is replaced, so that memory from any new form is released by
+// the matching delete whatever the runtime (sanitizers replace the default forms too).
+namespace {
+    void* Allocate(std::size_t size, std::size_t alignment)
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+
+        if (size == 0)
+            size = 1;
+
+        // aligned_alloc takes a multiple of the alignment.
+        if (alignment > DEFAULT_ALIGNMENT)
+            size = (size + alignment - 1) / alignment * alignment;
+
+        while (true)
+        {
+            void* ptr = alignment > DEFAULT_ALIGNMENT ? std::aligned_alloc(alignment, size) : std::malloc(size);
+            if (ptr != nullptr)
+                return ptr;
+
+            std::new_handler handler = std::get_new_handler();
+            if (handler == nullptr)
+                throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void* AllocateNoThrow(std::size_t size, std::size_t alignment) noexcept
+    {
+        try
+        {
+            return Allocate(size, alignment);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return nullptr;
+        }
+    }
+}
+
+void* operator new(std::size_t size) { return Allocate(size, DEFAULT_ALIGNMENT); }
+void* operator new[](std::size_t size) { return Allocate(size, DEFAULT_ALIGNMENT); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, DEFAULT_ALIGNMENT); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, DEFAULT_ALIGNMENT); }
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return Allocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return AllocateNoThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
@@ -9,13 +9,18 @@
 int main(int argc, char* argv[])
 {
     Parameters* param = new Parameters(argc, argv);
+    utils::SetSimdLevel(param->simd);
 
 #ifdef _OPENMP
-    int numThreads = omp_get_num_procs() / 2;
+    int numThreads = param->threads > 0 ? param->threads : std::max(1, omp_get_num_procs() / 2);
     omp_set_num_threads(numThreads);
 #endif
 
-    if (param->run_single_test)
+    if (!param->preprocess.empty())
+    {
+        RunPreprocess(param);
+    }
+    else if (param->run_single_test)
     {
         if (param->population == 0 || param->generation == 0) 
         {
@@ -4,10 +4,15 @@
 #include <string>
 #include <getopt.h>
 #include <iostream>
+#include <random>
+#include <cstdint>
+#include <cstdio>
+#include "simd_kernels.hpp"
 
 #define POPULATION 25
 #define GENERATION 1000
 #define STAGNATION 200
+#define NEIGHBORS 20
 
 #define TIME 600.0
 
@@ -17,8 +22,26 @@ public:
 
     Parameters(int argc, char *argv[])
     {
+        static const struct option longOptions[] = {
+            { "seed", required_argument, nullptr, 'S' },
+            { "islands", required_argument, nullptr, 'I' },
+            { "migration-interval", required_argument, nullptr, 'M' },
+            { "migrants", required_argument, nullptr, 'E' },
+            { "topology", required_argument, nullptr, 'O' },
+            { "repetitions", required_argument, nullptr, 'R' },
+            { "jobs", required_argument, nullptr, 'J' },
+            { "threads", required_argument, nullptr, 'P' },
+            { "steady-state", no_argument, nullptr, 'A' },
+            { "replicas", required_argument, nullptr, 'X' },
+            { "fitness-cache", required_argument, nullptr, 'C' },
+            { "simd", required_argument, nullptr, 'V' },
+            { "seeding", required_argument, nullptr, 'D' },
+            { "preprocess", required_argument, nullptr, 'B' },
+            { nullptr, 0, nullptr, 0 }
+        };
+
         int opt;
-        while ((opt = getopt(argc, argv, "p:g:s:t:a:")) != -1)
+        while ((opt = getopt_long(argc, argv, "p:g:s:t:a:T:k:S:", longOptions, nullptr)) != -1)
         {
             switch (opt)
             {
@@ -40,10 +63,80 @@ public:
             case 't':
                 time_limit = std::stod(optarg);
                 break;
+            case 'T':
+                tournament_size = std::stoi(optarg);
+                break;
+            case 'k':
+                neighbors = std::stoi(optarg);
+                break;
+            case 'S':
+                seed = std::stoull(optarg);
+                break;
+            case 'I':
+                islands = std::stoi(optarg);
+                break;
+            case 'M':
+                migration_interval = std::stoi(optarg);
+                break;
+            case 'E':
+                migrants = std::stoi(optarg);
+                break;
+            case 'O':
+                topology = optarg;
+                if (topology != "ring" && topology != "random" && topology != "full")
+                {
+                    std::cerr << "Invalid topology: " << topology << ". Use ring, random or full." << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case 'R':
+                repetitions = std::stoi(optarg);
+                break;
+            case 'J':
+                jobs = std::stoi(optarg);
+                break;
+            case 'P':
+                threads = std::stoi(optarg);
+                break;
+            case 'A':
+                steady_state = true;
+                break;
+            case 'X':
+                replicas = std::stoi(optarg);
+                break;
+            case 'C':
+                fitness_cache = std::stoi(optarg);
+                break;
+            case 'V':
+                if (!utils::ParseSimdLevel(optarg, simd))
+                {
+                    std::cerr << "Invalid SIMD level: " << optarg << ". Use auto, avx512, avx2 or scalar." << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case 'D':
+                if (std::sscanf(optarg, "%d,%d,%d,%d", &seeding_kmeans, &seeding_savings, &seeding_sweep,
+                                &seeding_random) != 4 ||
+                    seeding_kmeans < 0 || seeding_savings < 0 || seeding_sweep < 0 || seeding_random < 0 ||
+                    seeding_kmeans + seeding_savings + seeding_sweep + seeding_random == 0)
+                {
+                    std::cerr << "Invalid seeding: " << optarg
+                              << ". Use four non-negative weights kmeans,savings,sweep,random, not all zero." << std::endl;
+                    std::exit(EXIT_FAILURE);
+                }
+                break;
+            case 'B':
+                preprocess = optarg;
+                break;
             default:
                 std::cerr << "Usage: " << argv[0]
                           << " <file> [-p pop_size] [-g generation_size]"
-                          << "[-s stagnation_limit] [-t time_limit] [-a GA|MA]"
+                          << "[-s stagnation_limit] [-t time_limit] [-a GA|MA|MA-LS|MA-PT|PT] [-T tournament_size]"
+                          << "[-k neighbors] [--seed seed] [--islands n] [--migration-interval n]"
+                          << "[--migrants n] [--topology ring|random|full] [--repetitions n] [--jobs n]"
+                          << "[--threads n] [--steady-state] [--replicas n]"
+                          << "[--fitness-cache entries] [--simd auto|avx512|avx2|scalar]"
+                          << "[--seeding kmeans,savings,sweep,random] [--preprocess output]"
                           << std::endl;
                 std::exit(EXIT_FAILURE);
             }
@@ -66,13 +159,36 @@ public:
     int max_x = 0;
     int max_y = 0;
     int stagnation_limit = STAGNATION;
+    int tournament_size = 0;
+    int neighbors = NEIGHBORS;
+    int islands = 1;
+    int migration_interval = 50;
+    int migrants = 2;
+    int repetitions = 10;
+    int jobs = 1;
+    int threads = 0;
+    int replicas = 4;
+    int fitness_cache = 8192;
+
+    // Weights of the constructors of the initial population; savings and sweep are opt-in.
+    int seeding_kmeans = 1;
+    int seeding_savings = 0;
+    int seeding_sweep = 0;
+    int seeding_random = 1;
+
+    uint64_t seed = std::random_device{}();
+
+    utils::SimdLevel simd = utils::DetectSimdLevel();
 
     double time_limit = TIME;
 
     bool run_single_test = false;
+    bool steady_state = false;
 
     std::string algorithm = "GA";
+    std::string topology = "ring";
     std::string input_file;
+    std::string preprocess;     // Output of the preprocessed instance; empty to run the algorithm.
 };
 
 #endif
@@ -0,0 +1,340 @@
+#include "simd_kernels.hpp"
+#include <atomic>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Scalar versions: the reference the vector ones must match.
+
+size_t ArgminScalar(const double* xs, const double* ys, size_t count, double px, double py)
+{
+    size_t best = 0;
+    double bestDistance = std::numeric_limits<double>::infinity();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        double distance = dx * dx + dy * dy;
+
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+void AssignScalar(const double* xs, const double* ys, size_t begin, size_t count, const double* cx, const double* cy,
+                  size_t k, int* assignment)
+{
+    for (size_t i = begin; i < count; ++i)
+    {
+        int best = 0;
+        double bestDistance = std::numeric_limits<double>::infinity();
+
+        for (size_t c = 0; c < k; ++c)
+        {
+            double dx = xs[i] - cx[c];
+            double dy = ys[i] - cy[c];
+            double distance = dx * dx + dy * dy;
+
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = static_cast<int>(c);
+            }
+        }
+
+        assignment[i] = best;
+    }
+}
+
+#ifdef SIMD_X86
+
+// Each lane keeps the first minimum of its own subsequence; lanes are then reduced keeping
+// the smallest distance and, among equal ones, the smallest index.
+
+__attribute__((target("avx2")))
+size_t ArgminAVX2(const double* xs, const double* ys, size_t count, double px, double py)
+{
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    __m256d bestDistance = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    __m256d bestIndex = _mm256_set1_pd(0);
+    __m256d index = _mm256_setr_pd(0, 1, 2, 3);
+    const __m256d step = _mm256_set1_pd(4);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vy);
+        __m256d distance = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+        __m256d less = _mm256_cmp_pd(distance, bestDistance, _CMP_LT_OQ);
+        bestDistance = _mm256_blendv_pd(bestDistance, distance, less);
+        bestIndex = _mm256_blendv_pd(bestIndex, index, less);
+        index = _mm256_add_pd(index, step);
+    }
+
+    alignas(32) double distances[4];
+    alignas(32) double indices[4];
+    _mm256_store_pd(distances, bestDistance);
+    _mm256_store_pd(indices, bestIndex);
+
+    size_t best = 0;
+    double minimum = std::numeric_limits<double>::infinity();
+
+    for (int lane = 0; lane < 4; ++lane)
+    {
+        size_t laneIndex = static_cast<size_t>(indices[lane]);
+        if (distances[lane] < minimum || (distances[lane] == minimum && laneIndex < best))
+        {
+            minimum = distances[lane];
+            best = laneIndex;
+        }
+    }
+
+    for (; i < count; ++i)
+    {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        double distance = dx * dx + dy * dy;
+
+        if (distance < minimum)
+        {
+            minimum = distance;
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+__attribute__((target("avx2")))
+void AssignAVX2(const double* xs, const double* ys, size_t count, const double* cx, const double* cy,
+                size_t k, int* assignment)
+{
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m256d x = _mm256_loadu_pd(xs + i);
+        __m256d y = _mm256_loadu_pd(ys + i);
+        __m256d bestDistance = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+        __m256d best = _mm256_setzero_pd();
+
+        for (size_t c = 0; c < k; ++c)
+        {
+            __m256d dx = _mm256_sub_pd(x, _mm256_set1_pd(cx[c]));
+            __m256d dy = _mm256_sub_pd(y, _mm256_set1_pd(cy[c]));
+            __m256d distance = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+            __m256d less = _mm256_cmp_pd(distance, bestDistance, _CMP_LT_OQ);
+            bestDistance = _mm256_blendv_pd(bestDistance, distance, less);
+            best = _mm256_blendv_pd(best, _mm256_set1_pd(static_cast<double>(c)), less);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(assignment + i), _mm256_cvttpd_epi32(best));
+    }
+
+    AssignScalar(xs, ys, i, count, cx, cy, k, assignment);
+}
+
+__attribute__((target("avx512f")))
+size_t ArgminAVX512(const double* xs, const double* ys, size_t count, double px, double py)
+{
+    const __m512d vx = _mm512_set1_pd(px);
+    const __m512d vy = _mm512_set1_pd(py);
+    __m512d bestDistance = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+    __m512i bestIndex = _mm512_setzero_si512();
+    __m512i index = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i step = _mm512_set1_epi64(8);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d dx = _mm512_sub_pd(_mm512_loadu_pd(xs + i), vx);
+        __m512d dy = _mm512_sub_pd(_mm512_loadu_pd(ys + i), vy);
+        __m512d distance = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+        __mmask8 less = _mm512_cmp_pd_mask(distance, bestDistance, _CMP_LT_OQ);
+        bestDistance = _mm512_mask_blend_pd(less, bestDistance, distance);
+        bestIndex = _mm512_mask_blend_epi64(less, bestIndex, index);
+        index = _mm512_add_epi64(index, step);
+    }
+
+    // The tail is loaded with a mask; missing lanes read as infinity and never win.
+    if (i < count)
+    {
+        __mmask8 mask = static_cast<__mmask8>((1u << (count - i)) - 1);
+        __m512d infinity = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+        __m512d dx = _mm512_sub_pd(_mm512_mask_loadu_pd(infinity, mask, xs + i), vx);
+        __m512d dy = _mm512_sub_pd(_mm512_mask_loadu_pd(_mm512_setzero_pd(), mask, ys + i), vy);
+        __m512d distance = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+        __mmask8 less = _mm512_mask_cmp_pd_mask(mask, distance, bestDistance, _CMP_LT_OQ);
+        bestDistance = _mm512_mask_blend_pd(less, bestDistance, distance);
+        bestIndex = _mm512_mask_blend_epi64(less, bestIndex, index);
+    }
+
+    alignas(64) double distances[8];
+    alignas(64) long long indices[8];
+    _mm512_store_pd(distances, bestDistance);
+    _mm512_store_si512(indices, bestIndex);
+
+    size_t best = 0;
+    double minimum = std::numeric_limits<double>::infinity();
+
+    for (int lane = 0; lane < 8; ++lane)
+    {
+        size_t laneIndex = static_cast<size_t>(indices[lane]);
+        if (distances[lane] < minimum || (distances[lane] == minimum && laneIndex < best))
+        {
+            minimum = distances[lane];
+            best = laneIndex;
+        }
+    }
+
+    return best;
+}
+
+__attribute__((target("avx512f")))
+void AssignAVX512(const double* xs, const double* ys, size_t count, const double* cx, const double* cy,
+                  size_t k, int* assignment)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m512d x = _mm512_loadu_pd(xs + i);
+        __m512d y = _mm512_loadu_pd(ys + i);
+        __m512d bestDistance = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+        __m256i best = _mm256_setzero_si256();
+
+        for (size_t c = 0; c < k; ++c)
+        {
+            __m512d dx = _mm512_sub_pd(x, _mm512_set1_pd(cx[c]));
+            __m512d dy = _mm512_sub_pd(y, _mm512_set1_pd(cy[c]));
+            __m512d distance = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+
+            __mmask8 less = _mm512_cmp_pd_mask(distance, bestDistance, _CMP_LT_OQ);
+            bestDistance = _mm512_mask_blend_pd(less, bestDistance, distance);
+            best = _mm512_castsi512_si256(_mm512_mask_blend_epi32(less, _mm512_castsi256_si512(best),
+                                                                  _mm512_set1_epi32(static_cast<int>(c))));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(assignment + i), best);
+    }
+
+    AssignScalar(xs, ys, i, count, cx, cy, k, assignment);
+}
+
+#endif
+
+std::atomic<int> selectedLevel{-1};
+
+}
+
+namespace utils {
+
+SimdLevel DetectSimdLevel()
+{
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel GetSimdLevel()
+{
+    int level = selectedLevel.load(std::memory_order_relaxed);
+
+    if (level < 0)
+    {
+        level = static_cast<int>(DetectSimdLevel());
+        selectedLevel.store(level, std::memory_order_relaxed);
+    }
+
+    return static_cast<SimdLevel>(level);
+}
+
+void SetSimdLevel(SimdLevel level)
+{
+    int detected = static_cast<int>(DetectSimdLevel());
+    selectedLevel.store(std::min(static_cast<int>(level), detected), std::memory_order_relaxed);
+}
+
+const char* SimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX512:
+        return "avx512";
+    case SimdLevel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+bool ParseSimdLevel(const std::string& name, SimdLevel& level)
+{
+    if (name == "auto")
+        level = DetectSimdLevel();
+    else if (name == "avx512")
+        level = SimdLevel::AVX512;
+    else if (name == "avx2")
+        level = SimdLevel::AVX2;
+    else if (name == "scalar")
+        level = SimdLevel::Scalar;
+    else
+        return false;
+
+    return true;
+}
+
+size_t ArgminSquaredDistance(const double* xs, const double* ys, size_t count, double px, double py)
+{
+    switch (GetSimdLevel())
+    {
+#ifdef SIMD_X86
+    case SimdLevel::AVX512:
+        return ArgminAVX512(xs, ys, count, px, py);
+    case SimdLevel::AVX2:
+        return ArgminAVX2(xs, ys, count, px, py);
+#endif
+    default:
+        return ArgminScalar(xs, ys, count, px, py);
+    }
+}
+
+void AssignNearest(const double* xs, const double* ys, size_t count, const double* cx, const double* cy,
+                   size_t k, int* assignment)
+{
+    switch (GetSimdLevel())
+    {
+#ifdef SIMD_X86
+    case SimdLevel::AVX512:
+        AssignAVX512(xs, ys, count, cx, cy, k, assignment);
+        return;
+    case SimdLevel::AVX2:
+        AssignAVX2(xs, ys, count, cx, cy, k, assignment);
+        return;
+#endif
+    default:
+        AssignScalar(xs, ys, 0, count, cx, cy, k, assignment);
+    }
+}
+
+}
@@ -0,0 +1,48 @@
+#include "../src/Core/chromosome.hpp"
+#include <cmath>
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool condition, const char* message)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << message << std::endl;
+        failures++;
+    }
+}
+
+int main()
+{
+    // Depot and three customers on a line; customer 2 alone exceeds the capacity.
+    std::vector<Node> nodes = {
+        Node(1, 0, 0, 0),
+        Node(2, 1, 0, 3),
+        Node(3, 2, 0, 12),
+        Node(4, 3, 0, 4),
+    };
+    int capacity = 10;
+
+    DistanceMatrix distances;
+    distances.Build(nodes);
+
+    GA::Chromosome infeasible(0, std::vector<gene_t>{ 1, 2, 3 });
+    infeasible.CalculateFitness(nodes, distances, capacity);
+
+    check(std::isinf(infeasible.getFitness()), "a customer above the capacity gives an infinite cost");
+    check(infeasible.getRoutes().empty(), "a customer above the capacity gives no routes");
+
+    // Once customer 2 fits, the loads 3, 5 and 4 need two routes.
+    nodes[2].setDemand(5);
+    GA::Chromosome feasible(0, std::vector<gene_t>{ 1, 2, 3 });
+    feasible.CalculateFitness(nodes, distances, capacity);
+
+    check(!std::isinf(feasible.getFitness()), "a feasible tour gets a finite cost");
+    check(feasible.getRoutes().size() == 2, "a feasible tour is split by the capacity");
+
+    if (failures == 0)
+        std::cout << "split_test: OK" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}